@@ -0,0 +1,211 @@
+#include "OscFanoutSender.h"
+#include "ofMain.h"
+#include "OscOutboundPacketStream.h"
+#include "UdpSocket.h"
+#include <algorithm>
+#include <sstream>
+
+// Escribe un int32 OSC (big-endian) en sitio
+static void writeOscInt32(char* p, int value) {
+    unsigned v = (unsigned)value;
+    p[0] = (char)(v >> 24);
+    p[1] = (char)(v >> 16);
+    p[2] = (char)(v >> 8);
+    p[3] = (char)v;
+}
+
+//--------------------------------------------------------------
+OscFanoutSender::OscFanoutSender() {
+    buffer.resize(kMaxMessageBytes * 256);
+    used = 0;
+    frame_hits = 0;
+    records.reserve(256);
+}
+
+//--------------------------------------------------------------
+OscFanoutSender::~OscFanoutSender() {
+}
+
+//--------------------------------------------------------------
+int OscFanoutSender::addDestination(const std::string& host, int port, unsigned filter, float max_hits_per_second) {
+    auto dest = std::make_unique<Destination>();
+    dest->host = host;
+    dest->port = port;
+    dest->filter = filter;
+    dest->max_hits_per_second = max_hits_per_second;
+    dest->tokens = max_hits_per_second;
+    dest->hits_sent = 0;
+    dest->hits_dropped_budget = 0;
+    dest->hit_seq = 0;
+    try {
+        dest->socket = std::make_unique<UdpTransmitSocket>(IpEndpointName(host.c_str(), port));
+    } catch (std::exception& e) {
+        ofLogError("OscFanoutSender") << "No se pudo abrir " << host << ":" << port << ": " << e.what();
+        return -1;
+    }
+    destinations.push_back(std::move(dest));
+    ofLogNotice("OscFanoutSender") << "Destino OSC " << host << ":" << port
+                                   << " filtro 0x" << std::hex << filter << std::dec
+                                   << " max_hits/s " << max_hits_per_second;
+    return (int)destinations.size() - 1;
+}
+
+//--------------------------------------------------------------
+int OscFanoutSender::loadDestinations(const std::string& path) {
+    ofFile file(path);
+    if (!file.exists()) {
+        return 0;
+    }
+    int added = 0;
+    ofBuffer text = file.readToBuffer();
+    for (auto& line : text.getLines()) {
+        std::string trimmed = ofTrim(line);
+        if (trimmed.empty() || trimmed[0] == '#') {
+            continue;
+        }
+        std::istringstream iss(trimmed);
+        std::string host;
+        int port = 0;
+        std::string kinds = "all";
+        float max_hits = 0.0f;
+        if (!(iss >> host >> port)) {
+            ofLogWarning("OscFanoutSender") << "Línea ignorada: " << trimmed;
+            continue;
+        }
+        iss >> kinds >> max_hits;
+        unsigned filter = 0;
+        for (auto& k : ofSplitString(kinds, ",", true, true)) {
+            if (k == "all") filter |= KIND_ALL;
+            else if (k == "hit") filter |= KIND_HIT;
+            else if (k == "state") filter |= KIND_STATE;
+            else if (k == "plate") filter |= KIND_PLATE;
+        }
+        if (addDestination(host, port, filter, max_hits) >= 0) {
+            added++;
+        }
+    }
+    return added;
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::clearDestinations() {
+    destinations.clear();
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::beginFrame(float dt_sec) {
+    for (auto& dest : destinations) {
+        if (dest->max_hits_per_second > 0.0f) {
+            // Burst = 1 s de presupuesto
+            dest->tokens = ofMin(dest->max_hits_per_second, dest->tokens + dest->max_hits_per_second * dt_sec);
+        }
+    }
+    used = 0;
+    records.clear();
+    frame_hits = 0;
+}
+
+//--------------------------------------------------------------
+char* OscFanoutSender::reserveMessage() {
+    if (used + kMaxMessageBytes > buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+    }
+    return buffer.data() + used;
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::commitMessage(size_t size, unsigned kind, size_t seq_offset) {
+    records.push_back({used, size, kind, seq_offset});
+    used += size;
+    if (kind == KIND_HIT) {
+        frame_hits++;
+    }
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::patchHitSequence(int seq, int count) {
+    // seq/count dependen del destino (presupuesto propio): se reescriben en sitio antes de cada envío
+    for (const auto& r : records) {
+        if (r.kind != KIND_HIT) {
+            continue;
+        }
+        char* p = buffer.data() + r.offset + r.seq_offset;
+        writeOscInt32(p, seq);
+        writeOscInt32(p + 4, count);
+    }
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::addHit(int id, float x, float y, float energy, int surface, int64_t t_ns) {
+    osc::OutboundPacketStream p(reserveMessage(), kMaxMessageBytes);
+    p << osc::BeginMessage("/hit")
+      << (osc::int32)id        // int32 id
+      << x                     // float x (0..1)
+      << y                     // float y (0..1)
+      << energy                // float energy (0..1)
+      << (osc::int32)surface   // int32 surface (0=L, 1=R, 2=T, 3=B, -1=N/A)
+      << (osc::int32)0         // int32 seq de frame (se rellena en flush por destino)
+      << (osc::int32)0;        // int32 count de /hit del frame para el destino
+    size_t trailing = 8;       // seq y count al final del mensaje
+    if (t_ns >= 0) {
+        // int32 t_us: OSC de PAS no admite int64; PAS lo reconstruye con su propio steady_clock
+        p << (osc::int32)(uint32_t)(t_ns / 1000);
+        trailing += 4;
+    }
+    p << osc::EndMessage;
+    commitMessage(p.Size(), KIND_HIT, p.Size() - trailing);
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::addState(float activity, float gesture, float presence) {
+    osc::OutboundPacketStream p(reserveMessage(), kMaxMessageBytes);
+    p << osc::BeginMessage("/state") << activity << gesture << presence << osc::EndMessage;
+    commitMessage(p.Size(), KIND_STATE);
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::addPlate(float freq, float amp, int mode) {
+    osc::OutboundPacketStream p(reserveMessage(), kMaxMessageBytes);
+    p << osc::BeginMessage("/plate") << freq << amp << (osc::int32)mode << osc::EndMessage;
+    commitMessage(p.Size(), KIND_PLATE);
+}
+
+//--------------------------------------------------------------
+void OscFanoutSender::flush() {
+    if (records.empty()) {
+        return;
+    }
+    for (auto& dest : destinations) {
+        if (frame_hits > 0 && (dest->filter & KIND_HIT) != 0) {
+            // El presupuesto corta la cola del batch: count refleja lo que este destino recibirá
+            int count = frame_hits;
+            if (dest->max_hits_per_second > 0.0f) {
+                count = std::max(0, std::min((int)dest->tokens, frame_hits));
+            }
+            if (count > 0) {
+                patchHitSequence(dest->hit_seq++, count);
+            }
+        }
+        for (const auto& r : records) {
+            if ((dest->filter & r.kind) == 0) {
+                continue;
+            }
+            if (r.kind == KIND_HIT && dest->max_hits_per_second > 0.0f) {
+                if (dest->tokens < 1.0f) {
+                    dest->hits_dropped_budget++;
+                    continue;
+                }
+                dest->tokens -= 1.0f;
+            }
+            try {
+                dest->socket->Send(buffer.data() + r.offset, r.size);
+            } catch (std::exception& e) {
+                ofLogError("OscFanoutSender") << "Envío fallido a " << dest->host << ":" << dest->port << ": " << e.what();
+                break;
+            }
+            if (r.kind == KIND_HIT) {
+                dest->hits_sent++;
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class UdpTransmitSocket;
+
+// Envío OSC a múltiples destinos (PAS, bridge de luces, grabador...).
+// Cada frame se serializa una sola vez en un buffer contiguo (un registro por mensaje);
+// cada destino reenvía los mismos bytes según su filtro de tipos y su presupuesto de /hit.
+class OscFanoutSender {
+public:
+    enum MessageKind {
+        KIND_HIT   = 1 << 0,
+        KIND_STATE = 1 << 1,
+        KIND_PLATE = 1 << 2,
+        KIND_ALL   = 0xFF
+    };
+
+    struct Destination {
+        std::string host;
+        int port;
+        unsigned filter;              // Máscara de MessageKind aceptados
+        float max_hits_per_second;    // Presupuesto de /hit (token bucket); <= 0 = sin límite
+        float tokens;                 // Tokens disponibles
+        int hits_sent;                // /hit enviados (acumulado)
+        int hits_dropped_budget;      // /hit descartados por presupuesto (acumulado)
+        int hit_seq;                  // Próximo seq de frame con /hit para este destino
+        std::unique_ptr<UdpTransmitSocket> socket;
+    };
+
+    OscFanoutSender();
+    ~OscFanoutSender();
+
+    // Devuelve el índice del destino o -1 si no se pudo abrir el socket
+    int addDestination(const std::string& host, int port, unsigned filter = KIND_ALL, float max_hits_per_second = 0.0f);
+    // Archivo de texto, una línea por destino: "host port [hit,state,plate|all] [max_hits/s]"; '#' = comentario
+    int loadDestinations(const std::string& path);
+    void clearDestinations();
+
+    // Inicio de frame: recarga tokens y vacía el batch (sin liberar memoria)
+    void beginFrame(float dt_sec);
+    // t_ns >= 0: añade t_us (32 bits bajos de t_ns / 1000) como sonda de latencia hit → sonido
+    void addHit(int id, float x, float y, float energy, int surface, int64_t t_ns = -1);
+    void addState(float activity, float gesture, float presence);
+    void addPlate(float freq, float amp, int mode);
+    // Envía el batch del frame a todos los destinos
+    void flush();
+
+    size_t getNumDestinations() const { return destinations.size(); }
+    const Destination& getDestination(size_t i) const { return *destinations[i]; }
+    size_t getBatchBytes() const { return used; }
+
+private:
+    static const size_t kMaxMessageBytes = 64;  // /hit serializado ocupa 48 bytes (52 con t_us)
+
+    struct Record {
+        size_t offset;
+        size_t size;
+        unsigned kind;
+        size_t seq_offset;        // /hit: posición de seq(int32) y count(int32) dentro del mensaje
+    };
+
+    std::vector<std::unique_ptr<Destination>> destinations;
+    std::vector<char> buffer;     // Batch serializado del frame (crece, no se libera)
+    size_t used;
+    std::vector<Record> records;
+    int frame_hits;               // /hit en el batch del frame
+
+    void patchHitSequence(int seq, int count);
+
+    char* reserveMessage();
+    void commitMessage(size_t size, unsigned kind, size_t seq_offset = 0);
+};
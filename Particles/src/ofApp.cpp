@@ -2,9 +2,23 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 
 const float ofApp::REST_SPEED_EPSILON_FACTOR = 0.01f;
 static const float ENERGY_FLOOR = 0.01f;  // Suelo perceptible; descartes por debajo (Fase 2)
+const float ofApp::AUTO_BUDGET_MIN_HITS = 50.0f;
+const float ofApp::LOAD_TIMEOUT_SEC = 2.0f;
+const float ofApp::STATE_DELTA_THRESHOLD = 0.02f;
+const float ofApp::PLATE_FREQ_DELTA_HZ = 1.0f;
+const float ofApp::PLATE_AMP_DELTA = 0.01f;
+const float ofApp::OSC_KEYFRAME_INTERVAL = 0.5f;
+
+//--------------------------------------------------------------
+// Mismo reloj que PAS (steady_clock) para que la sonda de latencia sea comparable en la misma máquina
+static int64_t hitTimestampNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 //--------------------------------------------------------------
 bool ofApp::isExternalForceActive() const {
@@ -49,9 +63,19 @@ void ofApp::setup(){
     // Presupuesto por frame (selección por energía antes del token bucket)
     // Temporary until PAS implements 20ms/4-quadrant fusion.
     target_hits_per_second = 500.0f;
+    auto_budget = true;
+    latency_probe = false;
+    synth_load.queue_fill = 0.0f;
+    synth_load.voices_active = 0;
+    synth_load.max_voices = 0;
+    synth_load.cpu = 0.0f;
+    synth_load.drop_rate = 0.0f;
+    synth_load.last_update_time = 0.0f;
+    synth_load.valid = false;
 
     // Parámetros de rate limiting
     max_hits_per_second = 800.0f;
+    target_hits_manual = max_hits_per_second;
     burst = 1000.0f;
     max_hits_per_frame = 50;
     max_hits_border_per_second = 200.0f;   // Fase 4: borde más estricto que p2p
@@ -129,6 +153,8 @@ void ofApp::setup(){
     gui.add(maxHitsPerSecondSlider.setup("max_hits/s", max_hits_per_second, 50.0f, 1000.0f));
     gui.add(burstSlider.setup("burst", burst, 100.0f, 1000.0f));
     gui.add(maxHitsPerFrameSlider.setup("max_hits/frame", max_hits_per_frame, 5, 50));
+    gui.add(autoBudgetToggle.setup("auto_budget (/load)", auto_budget));
+    gui.add(latencyProbeToggle.setup("latency_probe (/hit t_us)", latency_probe));
     
     // Slider de tamaño de partículas
     gui.add(particleSizeSlider.setup("particle_size", particleSize, 1.0f, 10.0f));
@@ -224,6 +250,7 @@ void ofApp::update(){
     
     // Actualizar parámetros de rate limiting
     max_hits_per_second = maxHitsPerSecondSlider;
+    target_hits_manual = max_hits_per_second;   // Objetivo sin /load: el del slider max_hits/s
     burst = burstSlider;
     max_hits_per_frame = maxHitsPerFrameSlider;
     rate_limiter.rate = max_hits_per_second;
@@ -234,6 +261,12 @@ void ofApp::update(){
     rate_limiter_pp.rate = max_hits_pp_per_second;
     rate_limiter_pp.burst = burst;
 
+    // Backpressure: leer /load de PAS y ajustar objetivo de hits/s
+    auto_budget = autoBudgetToggle;
+    latency_probe = latencyProbeToggle;
+    receiveLoadMessages();
+    updateAutoBudget();
+
     // Actualizar tamaño de partículas
     particleSize = particleSizeSlider;
     
@@ -362,6 +395,7 @@ void ofApp::update(){
     
     // Enviar eventos OSC validados (hits_sent_osc solo al enviar realmente)
     if (oscEnabled) {
+        oscOut.beginFrame(dt_sec);
         for (const auto& event : validated_hits) {
             sendHitEvent(event);
             hits_sent_osc++;
@@ -386,6 +420,9 @@ void ofApp::update(){
             sendPlateMessage();
             plateSendTimer = 0.0f;
         }
+        
+        // Un solo batch serializado por frame, reenviado a cada destino
+        oscOut.flush();
     }
     
     // Actualizar contadores de debug
@@ -407,6 +444,8 @@ void ofApp::update(){
         discarded_by_budget_accumulator = 0;
         sent_q0 = sent_q1 = sent_q2 = sent_q3 = 0;
         discarded_by_budget_q0 = discarded_by_budget_q1 = discarded_by_budget_q2 = discarded_by_budget_q3 = 0;
+        state_msgs_skipped = 0;
+        plate_msgs_skipped = 0;
     }
     update_total_ms = (ofGetElapsedTimef() - t_update_start) * 1000.0f;
 }
@@ -1012,6 +1051,7 @@ void ofApp::generateParticleHitEvent(Particle& p1, Particle& p2, ofVec2f collisi
     event.y = ofClamp(collisionPoint.y / ofGetHeight(), 0.0f, 1.0f);
     event.energy = energy;
     event.surface = -1;
+    event.t_ns = hitTimestampNs();
 
     pending_hits.push_back(event);
     hits_added_pending++;
@@ -1059,6 +1099,7 @@ void ofApp::generateHitEvent(Particle& p, int surface) {
     event.y = ofClamp(p.pos.y / ofGetHeight(), 0.0f, 1.0f);
     event.energy = energy;
     event.surface = surface;
+    event.t_ns = hitTimestampNs();
 
     pending_hits.push_back(event);
     hits_added_pending++;
@@ -1139,12 +1180,25 @@ void ofApp::drawDebugOverlay() {
     ss << "Discarded (low_energy): " << hits_discarded_low_energy << endl;
     ss << "Tokens border: " << rate_limiter_border.tokens << " pp: " << rate_limiter_pp.tokens << endl;
     ss << "frame cap: " << rate_limiter.hits_this_frame << "/" << rate_limiter.max_per_frame << endl;
+    ss << "delta skipped: state " << state_msgs_skipped << " plate " << plate_msgs_skipped << " (per_sec)" << endl;
+    ss << "target_hits/s: " << target_hits_per_second << (auto_budget && synth_load.valid ? " (auto)" : " (manual)") << endl;
+    if (synth_load.valid) {
+        ss << "PAS load: cpu " << synth_load.cpu << " queue " << synth_load.queue_fill << " voices " << synth_load.voices_active << "/" << synth_load.max_voices << " drop " << synth_load.drop_rate << endl;
+    } else {
+        ss << "PAS load: (sin /load en :" << loadPort << ")" << endl;
+    }
     ss << "OSC: " << (oscEnabled ? "ON" : "OFF");
-    if (oscEnabled) ss << " " << oscHost << ":" << oscPort;
+    if (oscEnabled) {
+        ss << " " << oscHost << ":" << oscPort << " destinos: " << oscOut.getNumDestinations();
+        for (size_t i = 1; i < oscOut.getNumDestinations(); i++) {
+            const auto& d = oscOut.getDestination(i);
+            ss << " | " << d.port << " drop " << d.hits_dropped_budget;
+        }
+    }
 
     float x = 20.0f;
     float lineHeight = 14.0f;
-    int lineCount = 26;
+    int lineCount = 29;
     float y = ofGetHeight() - (lineCount * lineHeight) - 20.0f;
     if (y < 20.0f) y = 20.0f;
 
@@ -1278,11 +1332,74 @@ void ofApp::setupOSC() {
     oscEnabled = true;
     stateSendInterval = 0.1f;  // 10 Hz
     stateSendTimer = 0.0f;
+    last_state_sent.valid = false;
+    last_plate_sent.valid = false;
+    state_msgs_skipped = 0;
+    plate_msgs_skipped = 0;
+    
+    // Inicializar sender OSC: PAS recibe todo sin presupuesto propio (ya aplica el token bucket);
+    // destinos adicionales (luces, grabador) opcionales en bin/data/osc_destinations.txt
+    oscOut.addDestination(oscHost, oscPort, OscFanoutSender::KIND_ALL, 0.0f);
+    int extraDestinations = oscOut.loadDestinations(ofToDataPath("osc_destinations.txt"));
+    if (extraDestinations > 0) {
+        ofLogNotice("ofApp") << "Destinos OSC adicionales: " << extraDestinations;
+    }
     
-    // Inicializar sender OSC
-    oscSender.setup(oscHost, oscPort);
+    // Receptor de feedback /load (backpressure desde PAS)
+    loadPort = 9001;
+    loadReceiver.setup(loadPort);
     
-    ofLogNotice("ofApp") << "OSC configurado: " << oscHost << ":" << oscPort;
+    ofLogNotice("ofApp") << "OSC configurado: " << oscHost << ":" << oscPort << " (/load en :" << loadPort << ")";
+}
+
+//--------------------------------------------------------------
+void ofApp::receiveLoadMessages() {
+    // /load queueFill(float) voicesActive(int32) maxVoices(int32) cpu(float) dropRate(float)
+    while (loadReceiver.hasWaitingMessages()) {
+        ofxOscMessage msg;
+        loadReceiver.getNextMessage(msg);
+        if (msg.getAddress() != "/load" || msg.getNumArgs() != 5) {
+            continue;
+        }
+        synth_load.queue_fill = ofClamp(msg.getArgAsFloat(0), 0.0f, 1.0f);
+        synth_load.voices_active = msg.getArgAsInt32(1);
+        synth_load.max_voices = msg.getArgAsInt32(2);
+        synth_load.cpu = ofClamp(msg.getArgAsFloat(3), 0.0f, 1.0f);
+        synth_load.drop_rate = ofClamp(msg.getArgAsFloat(4), 0.0f, 1.0f);
+        synth_load.last_update_time = ofGetElapsedTimef();
+        synth_load.valid = true;
+    }
+    if (synth_load.valid && ofGetElapsedTimef() - synth_load.last_update_time > LOAD_TIMEOUT_SEC) {
+        synth_load.valid = false;
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::updateAutoBudget() {
+    // Sin feedback (o desactivado): objetivo fijo
+    if (!auto_budget || !synth_load.valid) {
+        target_hits_per_second = target_hits_manual;
+        return;
+    }
+
+    // AIMD: bajar rápido ante sobrecarga, subir lento mientras PAS tenga margen.
+    // Techo = max_hits/s del slider (la red de seguridad del token bucket sigue aplicando).
+    const float kCpuHigh = 0.75f;    // Por encima: reducir
+    const float kCpuLow = 0.60f;     // Por debajo (y sin drops): aumentar
+    const float kDropHigh = 0.02f;
+    const float kQueueHigh = 0.5f;
+    const float kDecrease = 0.8f;    // Factor multiplicativo por segundo de sobrecarga
+    const float kIncreasePerSec = 50.0f; // Hits/s ganados por segundo con margen
+
+    bool overloaded = synth_load.cpu > kCpuHigh || synth_load.drop_rate > kDropHigh || synth_load.queue_fill > kQueueHigh;
+    bool headroom = synth_load.cpu < kCpuLow && synth_load.drop_rate <= 0.0f;
+
+    if (overloaded) {
+        target_hits_per_second *= std::pow(kDecrease, dt_sec);
+    } else if (headroom) {
+        target_hits_per_second += kIncreasePerSec * dt_sec;
+    }
+    target_hits_per_second = ofClamp(target_hits_per_second, AUTO_BUDGET_MIN_HITS, max_hits_per_second);
 }
 
 //--------------------------------------------------------------
@@ -1291,15 +1408,9 @@ void ofApp::sendHitEvent(const HitEvent& event) {
         return;
     }
     
-    ofxOscMessage msg;
-    msg.setAddress("/hit");
-    msg.addIntArg(event.id);           // int32 id
-    msg.addFloatArg(event.x);          // float x (0..1)
-    msg.addFloatArg(event.y);          // float y (0..1)
-    msg.addFloatArg(event.energy);     // float energy (0..1)
-    msg.addIntArg(event.surface);      // int32 surface (0=L, 1=R, 2=T, 3=B, -1=N/A)
-    
-    oscSender.sendMessage(msg, false);
+    // Serializado una vez en el batch del frame; se envía en oscOut.flush()
+    // Con latency_probe, t_us lleva el instante de detección para medir latencia hit → sonido
+    oscOut.addHit(event.id, event.x, event.y, event.energy, event.surface, latency_probe ? event.t_ns : -1);
     
     // Debug opcional (comentado para no saturar logs)
     // ofLogVerbose("ofApp") << "OSC /hit: id=" << event.id 
@@ -1321,13 +1432,25 @@ void ofApp::sendStateMessage() {
         return; // Sin actividad, no enviar
     }
     
-    ofxOscMessage msg;
-    msg.setAddress("/state");
-    msg.addFloatArg(activity);         // float activity (0..1)
-    msg.addFloatArg(calculateGesture()); // float gesture (0..1)
-    msg.addFloatArg(calculatePresence()); // float presence (0..1)
+    float gesture = calculateGesture();
+    float presence = calculatePresence();
+    
+    // Delta: omitir si nada cambió más que el umbral y no venció el keyframe
+    float now = ofGetElapsedTimef();
+    if (last_state_sent.valid && now - last_state_sent.time < OSC_KEYFRAME_INTERVAL &&
+        std::abs(activity - last_state_sent.activity) < STATE_DELTA_THRESHOLD &&
+        std::abs(gesture - last_state_sent.gesture) < STATE_DELTA_THRESHOLD &&
+        std::abs(presence - last_state_sent.presence) < STATE_DELTA_THRESHOLD) {
+        state_msgs_skipped++;
+        return;
+    }
+    last_state_sent.activity = activity;
+    last_state_sent.gesture = gesture;
+    last_state_sent.presence = presence;
+    last_state_sent.time = now;
+    last_state_sent.valid = true;
     
-    oscSender.sendMessage(msg, false);
+    oscOut.addState(activity, gesture, presence);
     
     // Debug opcional
     // ofLogVerbose("ofApp") << "OSC /state: activity=" << activity;
@@ -1344,13 +1467,22 @@ void ofApp::sendPlateMessage() {
     float amp = ofClamp(plateAmp, 0.0f, 1.0f);
     int mode = ofClamp(plateMode, 0, 7);
     
-    ofxOscMessage msg;
-    msg.setAddress("/plate");
-    msg.addFloatArg(freq);  // float freq (20.0-2000.0 Hz)
-    msg.addFloatArg(amp);   // float amp (0.0-1.0)
-    msg.addIntArg(mode);    // int32 mode (0-7)
+    // Delta: omitir si nada cambió; el keyframe mantiene vivo el fail-safe de PlateSynth (2 s)
+    float now = ofGetElapsedTimef();
+    if (last_plate_sent.valid && now - last_plate_sent.time < OSC_KEYFRAME_INTERVAL &&
+        std::abs(freq - last_plate_sent.freq) < PLATE_FREQ_DELTA_HZ &&
+        std::abs(amp - last_plate_sent.amp) < PLATE_AMP_DELTA &&
+        mode == last_plate_sent.mode) {
+        plate_msgs_skipped++;
+        return;
+    }
+    last_plate_sent.freq = freq;
+    last_plate_sent.amp = amp;
+    last_plate_sent.mode = mode;
+    last_plate_sent.time = now;
+    last_plate_sent.valid = true;
     
-    oscSender.sendMessage(msg, false);
+    oscOut.addPlate(freq, amp, mode);  // freq 20-2000 Hz, amp 0-1, mode 0-7
     
     // Debug opcional
     // ofLogVerbose("ofApp") << "OSC /plate: freq=" << freq << " amp=" << amp << " mode=" << mode;
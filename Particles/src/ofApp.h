@@ -4,6 +4,7 @@
 #include "ofxGui.h"
 #include "ofxOsc.h"
 #include "Particle.h"
+#include "OscFanoutSender.h"
 #include <vector>
 
 class ofApp : public ofBaseApp{
@@ -47,6 +48,7 @@ class ofApp : public ofBaseApp{
 			float y;              // Posición Y normalizada (0..1)
 			float energy;         // Energía del impacto (0..1)
 			int surface;          // Superficie impactada (0=L, 1=R, 2=T, 3=B, -1=N/A)
+			int64_t t_ns;         // steady_clock al detectar el impacto (sonda de latencia)
 		};
 		
 		// Estructura para rate limiting (token bucket)
@@ -89,6 +91,22 @@ class ofApp : public ofBaseApp{
 		// Presupuesto por frame (selección antes del token bucket)
 		float target_hits_per_second;  // Objetivo OSC/s (ej. 800); budget_frame = min(max_per_frame, ceil(target/fps))
 
+		// Backpressure (/load desde PAS): lazo cerrado sobre target_hits_per_second
+		struct SynthLoad {
+			float queue_fill;     // Pico de ocupación de colas PAS (0..1)
+			int voices_active;    // Voces sonando
+			int max_voices;       // Límite de voces configurado en PAS
+			float cpu;            // Carga del audio callback (0..1)
+			float drop_rate;      // Hits descartados / recibidos en el intervalo (0..1)
+			float last_update_time; // ofGetElapsedTimef() del último /load
+			bool valid;           // Se recibió al menos un /load reciente
+		} synth_load;
+		bool auto_budget;                 // Lazo cerrado activo (si false, target fijo)
+		bool latency_probe;               // /hit con t_us para medir latencia hit → sonido (maad-2-calib latency)
+		float target_hits_manual;         // Objetivo sin feedback (y al perder /load) = slider max_hits/s
+		static const float AUTO_BUDGET_MIN_HITS;     // Piso del objetivo adaptativo (hits/s)
+		static const float LOAD_TIMEOUT_SEC;         // Sin /load durante este tiempo -> volver a manual
+
 		// Parámetros de rate limiting
 		float max_hits_per_second;  // Máximo de hits por segundo (50-1000)
 		float burst;                // Burst máximo (100-1000)
@@ -152,12 +170,35 @@ class ofApp : public ofBaseApp{
 		std::vector<HitEvent> validated_hits;  // Eventos validados (para futuro OSC)
 		
 		// OSC
-		ofxOscSender oscSender;               // Sender a JUCE (puerto 9000)
-		std::string oscHost;                   // Host destino (default: 127.0.0.1)
-		int oscPort;                          // Puerto destino (default: 9000)
+		OscFanoutSender oscOut;               // Fan-out: PAS (puerto 9000) + destinos de osc_destinations.txt
+		std::string oscHost;                   // Host destino principal (default: 127.0.0.1)
+		int oscPort;                          // Puerto destino principal (default: 9000)
 		bool oscEnabled;                       // Habilitar/deshabilitar OSC
 		float stateSendInterval;              // Intervalo para enviar /state (segundos)
 		float stateSendTimer;                 // Timer para /state
+		// Delta: /state y /plate solo se envían si cambian más que el umbral o vence el keyframe
+		struct SentState {
+			float activity;
+			float gesture;
+			float presence;
+			float time;           // ofGetElapsedTimef() del último envío
+			bool valid;
+		} last_state_sent;
+		struct SentPlate {
+			float freq;
+			float amp;
+			int mode;
+			float time;
+			bool valid;
+		} last_plate_sent;
+		int state_msgs_skipped;               // /state omitidos por delta (per_sec)
+		int plate_msgs_skipped;               // /plate omitidos por delta (per_sec)
+		static const float STATE_DELTA_THRESHOLD;   // Cambio mínimo en activity/gesture/presence
+		static const float PLATE_FREQ_DELTA_HZ;     // Cambio mínimo de freq
+		static const float PLATE_AMP_DELTA;         // Cambio mínimo de amp
+		static const float OSC_KEYFRAME_INTERVAL;   // Reenvío completo aunque no cambie (< fail-safe PAS de 2 s)
+		ofxOscReceiver loadReceiver;          // Feedback /load desde JUCE (puerto 9001)
+		int loadPort;                         // Puerto de escucha de /load (default: 9001)
 		
 		// GUI
 		ofxPanel gui;
@@ -181,6 +222,8 @@ class ofApp : public ofBaseApp{
 		ofxFloatSlider particleSizeSlider;
 		ofxFloatSlider cameraZoomSlider;
 		ofxFloatSlider cameraRotationSlider;
+		ofxToggle autoBudgetToggle;
+		ofxToggle latencyProbeToggle;
 		
 		// Plate Controller UI
 		ofxFloatSlider plateFreqSlider;
@@ -244,6 +287,8 @@ class ofApp : public ofBaseApp{
 		void sendHitEvent(const HitEvent& event);
 		void sendStateMessage();
 		void sendPlateMessage();
+		void receiveLoadMessages();            // Drenar /load pendientes (no bloqueante)
+		void updateAutoBudget();               // AIMD sobre target_hits_per_second según carga PAS
 		float calculateActivity();            // Calcular actividad normalizada (0..1)
 		float calculateGesture();              // Calcular energía de gesto (0..1)
 		float calculatePresence();             // Calcular confianza tracking (0..1)
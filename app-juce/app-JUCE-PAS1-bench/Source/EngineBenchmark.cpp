@@ -0,0 +1,298 @@
+#include "EngineBenchmark.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+    const char* const waveformNames[] = { "Noise", "Sine", "Square", "Saw", "Triangle", "Click", "Pulse" };
+
+    constexpr double ENGINE_HIT_RATE = 2000.0;     // Hits/s en el suite engine (cascada densa)
+    constexpr double RETRIGGER_SECONDS = 0.1;      // Re-disparo de voz/placa: excitación dentro de la medición
+}
+
+//==============================================================================
+EngineBenchmark::EngineBenchmark(const Config& c)
+    : config(c)
+{
+    config.seconds = juce::jmax(0.1, config.seconds);
+}
+
+//==============================================================================
+std::vector<EngineBenchmark::Result> EngineBenchmark::run()
+{
+    std::vector<Result> results;
+    if (suiteEnabled("voice"))
+        runModalVoice(results);
+    if (suiteEnabled("manager"))
+        runVoiceManager(results);
+    if (suiteEnabled("plate"))
+        runPlateSynth(results);
+    if (suiteEnabled("engine"))
+        runSynthesisEngine(results);
+    return results;
+}
+
+//==============================================================================
+bool EngineBenchmark::suiteEnabled(const char* name) const
+{
+    return config.suite.isEmpty() || config.suite == name;
+}
+
+int EngineBenchmark::numBlocksFor(double sampleRate, int blockSize) const
+{
+    return WARMUP_BLOCKS + juce::jmax(1, (int)(config.seconds * sampleRate / (double)blockSize));
+}
+
+void EngineBenchmark::BlockTimes::add(juce::int64 blockTicks, int activeVoices)
+{
+    ticks.push_back(blockTicks);
+    activeVoiceSum += (double)activeVoices;
+}
+
+//==============================================================================
+void EngineBenchmark::runModalVoice(std::vector<Result>& results)
+{
+    // Una voz por forma de onda: coste de excitación + banco de modos + ADSR/sub-osc
+    const double sampleRate = 48000.0;
+    const int blockSize = 256;
+    const int numWaveforms = config.quick ? 2 : (int)(sizeof(waveformNames) / sizeof(waveformNames[0]));
+
+    ExcitationTables tables;
+    tables.prepare(sampleRate);
+    std::vector<float> out((size_t)blockSize);
+    BlockTimes times;
+
+    for (int w = 0; w < numWaveforms; w++)
+    {
+        ModalVoice voice;
+        voice.prepare(sampleRate);
+        voice.setExcitationTables(&tables);
+
+        const int numBlocks = numBlocksFor(sampleRate, blockSize);
+        const int retriggerBlocks = juce::jmax(1, (int)(RETRIGGER_SECONDS * sampleRate / blockSize));
+        times.prepare(numBlocks);
+
+        for (int b = 0; b < numBlocks; b++)
+        {
+            if (b % retriggerBlocks == 0)
+            {
+                voice.setParameters(300.0f, 0.8f, 0.7f, 0.6f, 0.5f, static_cast<ModalVoice::ExcitationWaveform>(w), 0.2f);
+                voice.trigger();
+            }
+
+            std::fill(out.begin(), out.end(), 0.0f);
+            auto start = juce::Time::getHighResolutionTicks();
+            voice.renderBlock(out.data(), blockSize);
+            auto elapsed = juce::Time::getHighResolutionTicks() - start;
+            if (b >= WARMUP_BLOCKS)
+                times.add(elapsed, voice.isActive() ? 1 : 0);
+        }
+
+        results.push_back(summarize(times, "voice", waveformNames[w], sampleRate, blockSize, 1, true));
+    }
+}
+
+//==============================================================================
+void EngineBenchmark::runVoiceManager(std::vector<Result>& results)
+{
+    // Pool lleno: las voces que terminan se reponen antes del bloque (el trigger no se mide)
+    const double sampleRate = 48000.0;
+    const std::vector<int> voiceCounts = config.quick ? std::vector<int>{ 8, 64 } : std::vector<int>{ 8, 32, 64, 128, 256, 1024 };
+    const std::vector<int> blockSizes = config.quick ? std::vector<int>{ 256 } : std::vector<int>{ 64, 256, 1024 };
+    BlockTimes times;
+
+    for (int voices : voiceCounts)
+    {
+        for (int blockSize : blockSizes)
+        {
+            auto manager = std::make_unique<VoiceManager>();
+            manager->prepare(sampleRate, voices, juce::jmax(VoiceManager::DEFAULT_POOL_SIZE, voices));
+            manager->setRenderWorkers(config.threads);
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            juce::Random random(1234);
+
+            const int numBlocks = numBlocksFor(sampleRate, blockSize);
+            times.prepare(numBlocks);
+
+            for (int b = 0; b < numBlocks; b++)
+            {
+                for (int t = 0; t < voices && manager->getActiveVoiceCount() < voices; t++)
+                {
+                    float freq = 100.0f + 700.0f * random.nextFloat();
+                    manager->triggerVoice(freq, 0.5f, 0.8f, 0.6f, 0.5f, ModalVoice::ExcitationWaveform::Noise, 0.0f,
+                                          1.0f, 1.0f, random.nextInt(4));
+                }
+
+                buffer.clear();
+                auto start = juce::Time::getHighResolutionTicks();
+                manager->renderNextBlock(buffer, 0, blockSize);
+                auto elapsed = juce::Time::getHighResolutionTicks() - start;
+                if (b >= WARMUP_BLOCKS)
+                    times.add(elapsed, manager->getActiveVoiceCount());
+            }
+
+            results.push_back(summarize(times, "manager", threadsVariant("lanes"), sampleRate, blockSize, voices, true));
+        }
+    }
+}
+
+//==============================================================================
+void EngineBenchmark::runPlateSynth(std::vector<Result>& results)
+{
+    const std::vector<double> sampleRates = config.quick ? std::vector<double>{ 48000.0 } : std::vector<double>{ 44100.0, 48000.0, 96000.0 };
+    const std::vector<int> blockSizes = config.quick ? std::vector<int>{ 256 } : std::vector<int>{ 64, 256, 1024 };
+    BlockTimes times;
+
+    for (double sampleRate : sampleRates)
+    {
+        for (int blockSize : blockSizes)
+        {
+            PlateSynth plate;
+            plate.prepare(sampleRate);
+            juce::AudioBuffer<float> buffer(2, blockSize);
+
+            const int numBlocks = numBlocksFor(sampleRate, blockSize);
+            const int retriggerBlocks = juce::jmax(1, (int)(RETRIGGER_SECONDS * sampleRate / blockSize));
+            times.prepare(numBlocks);
+
+            for (int b = 0; b < numBlocks; b++)
+            {
+                // Cambio de modo en cada re-disparo: incluye el recálculo de coeficientes
+                if (b % retriggerBlocks == 0)
+                    plate.triggerPlate(220.0f, 0.8f, (b / retriggerBlocks) % 8);
+
+                buffer.clear();
+                auto start = juce::Time::getHighResolutionTicks();
+                plate.renderNextBlock(buffer, 0, blockSize);
+                auto elapsed = juce::Time::getHighResolutionTicks() - start;
+                if (b >= WARMUP_BLOCKS)
+                    times.add(elapsed, 0);
+            }
+
+            results.push_back(summarize(times, "plate", "stereo", sampleRate, blockSize, 0, false));
+        }
+    }
+}
+
+//==============================================================================
+void EngineBenchmark::runSynthesisEngine(std::vector<Result>& results)
+{
+    // Camino completo del audio callback: cola de eventos, voces, placa y master bus
+    const std::vector<double> sampleRates = config.quick ? std::vector<double>{ 48000.0 } : std::vector<double>{ 44100.0, 48000.0, 96000.0 };
+    const std::vector<int> blockSizes = config.quick ? std::vector<int>{ 256 } : std::vector<int>{ 64, 256, 1024 };
+    const std::vector<int> voiceCounts = config.quick ? std::vector<int>{ 8, 64 } : std::vector<int>{ 8, 64, 256, 1024 };
+    const juce::String variant = threadsVariant(juce::String((int)ENGINE_HIT_RATE) + " hits/s");
+    BlockTimes times;
+
+    for (double sampleRate : sampleRates)
+    {
+        for (int blockSize : blockSizes)
+        {
+            for (int voices : voiceCounts)
+            {
+                auto engine = std::make_unique<SynthesisEngine>();
+                engine->setVoicePoolSize(juce::jmax(VoiceManager::DEFAULT_POOL_SIZE, voices));
+                engine->prepare(sampleRate);
+                engine->setMaxVoices(voices);
+                engine->setVoiceRenderThreads(config.threads);
+                juce::AudioBuffer<float> buffer(2, blockSize);
+                juce::Random random(1234);
+
+                const int numBlocks = numBlocksFor(sampleRate, blockSize);
+                const int retriggerBlocks = juce::jmax(1, (int)(RETRIGGER_SECONDS * sampleRate / blockSize));
+                const double hitsPerBlock = ENGINE_HIT_RATE * (double)blockSize / sampleRate;
+                double pendingHits = 0.0;
+                times.prepare(numBlocks);
+
+                for (int b = 0; b < numBlocks; b++)
+                {
+                    for (pendingHits += hitsPerBlock; pendingHits >= 1.0; pendingHits -= 1.0)
+                    {
+                        float energy = 0.2f + 0.8f * random.nextFloat();
+                        engine->triggerVoiceFromOSC(100.0f + 700.0f * random.nextFloat(), energy * energy, 0.7f,
+                                                    0.3f + 0.7f * energy, 0.5f,
+                                                    static_cast<ModalVoice::ExcitationWaveform>(random.nextInt(7)));
+                    }
+                    if (b % retriggerBlocks == 0)
+                        engine->triggerPlateFromOSC(220.0f, 0.6f, (b / retriggerBlocks) % 8);
+
+                    buffer.clear();
+                    auto start = juce::Time::getHighResolutionTicks();
+                    engine->renderNextBlock(buffer, 0, blockSize);
+                    auto elapsed = juce::Time::getHighResolutionTicks() - start;
+                    if (b >= WARMUP_BLOCKS)
+                        times.add(elapsed, engine->getActiveVoiceCount());
+                }
+
+                results.push_back(summarize(times, "engine", variant, sampleRate, blockSize, voices, true));
+            }
+        }
+    }
+}
+
+//==============================================================================
+juce::String EngineBenchmark::threadsVariant(const juce::String& variant) const
+{
+    return config.threads > 0 ? variant + " +" + juce::String(config.threads) + "t" : variant;
+}
+
+//==============================================================================
+EngineBenchmark::Result EngineBenchmark::summarize(BlockTimes& times, const juce::String& suite, const juce::String& variant,
+                                                   double sampleRate, int blockSize, int voices, bool perVoice)
+{
+    Result result;
+    result.suite = suite;
+    result.variant = variant;
+    result.sampleRate = sampleRate;
+    result.blockSize = blockSize;
+    result.voices = voices;
+    result.blocks = (int)times.ticks.size();
+    if (times.ticks.empty())
+        return result;
+
+    std::sort(times.ticks.begin(), times.ticks.end());
+    const double ticksToUs = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+    double sum = 0.0;
+    for (auto t : times.ticks)
+        sum += (double)t;
+
+    size_t p99Index = (size_t)std::ceil(0.99 * (double)times.ticks.size()) - 1;
+    result.meanUs = sum / (double)times.ticks.size() * ticksToUs;
+    result.p99Us = (double)times.ticks[p99Index] * ticksToUs;
+    result.maxUs = (double)times.ticks.back() * ticksToUs;
+    result.p99BudgetPercent = 100.0 * result.p99Us / (1.0e6 * (double)blockSize / sampleRate);
+    result.avgActiveVoices = times.activeVoiceSum / (double)times.ticks.size();
+    if (perVoice && result.avgActiveVoices > 0.0)
+        result.nsPerVoiceSample = result.meanUs * 1000.0 / (result.avgActiveVoices * (double)blockSize);
+    return result;
+}
+
+//==============================================================================
+void EngineBenchmark::printResults(const std::vector<Result>& results)
+{
+    std::printf("%-8s %-12s %7s %6s %6s %7s %7s %10s %10s %10s %8s %10s\n",
+                "suite", "variant", "sr", "block", "voices", "active", "blocks",
+                "mean_us", "p99_us", "max_us", "p99_%", "ns/v/smp");
+    for (const auto& r : results)
+    {
+        std::printf("%-8s %-12s %7.0f %6d %6d %7.1f %7d %10.2f %10.2f %10.2f %8.2f %10.2f\n",
+                    r.suite.toRawUTF8(), r.variant.toRawUTF8(), r.sampleRate, r.blockSize, r.voices,
+                    r.avgActiveVoices, r.blocks, r.meanUs, r.p99Us, r.maxUs, r.p99BudgetPercent, r.nsPerVoiceSample);
+    }
+}
+
+//==============================================================================
+bool EngineBenchmark::writeCsv(const std::vector<Result>& results, const juce::File& file)
+{
+    juce::String csv = "suite,variant,sample_rate,block_size,voices,avg_active_voices,blocks,"
+                       "mean_us,p99_us,max_us,p99_budget_percent,ns_per_voice_sample\n";
+    for (const auto& r : results)
+    {
+        csv << r.suite << "," << r.variant << "," << juce::String(r.sampleRate, 0) << "," << juce::String(r.blockSize) << ","
+            << juce::String(r.voices) << "," << juce::String(r.avgActiveVoices, 2) << "," << juce::String(r.blocks) << ","
+            << juce::String(r.meanUs, 3) << "," << juce::String(r.p99Us, 3) << "," << juce::String(r.maxUs, 3) << ","
+            << juce::String(r.p99BudgetPercent, 3) << "," << juce::String(r.nsPerVoiceSample, 3) << "\n";
+    }
+    return file.replaceWithText(csv);
+}
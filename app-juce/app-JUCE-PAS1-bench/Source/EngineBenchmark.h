@@ -0,0 +1,84 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SynthesisEngine.h"
+#include <vector>
+
+//==============================================================================
+/**
+    Benchmark del motor de audio: tiempo por bloque de ModalVoice, VoiceManager, PlateSynth y
+    SynthesisEngine en barridos de forma de onda, voces, sample rate y tamaño de bloque.
+
+    Cada caso renderiza `seconds` de audio cronometrando solo la llamada de render de cada
+    bloque (triggers fuera de la medición, salvo en SynthesisEngine, donde drenar la cola es
+    parte del bloque) y reporta media, p99 y máximo: el audio en tiempo real falla por el peor
+    bloque, no por la media. Los primeros WARMUP_BLOCKS bloques no cuentan (caches frías).
+*/
+class EngineBenchmark
+{
+public:
+    //==============================================================================
+    struct Config
+    {
+        double seconds = 2.0;   // Audio renderizado por caso
+        bool quick = false;     // Barrido reducido (smoke test)
+        juce::String suite;     // Vacío = todas; "voice", "manager", "plate" o "engine"
+        int threads = 0;        // Hilos auxiliares de render de voces (manager, engine)
+    };
+
+    struct Result
+    {
+        juce::String suite;
+        juce::String variant;   // Forma de onda u otra variante del caso
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        int voices = 0;         // Voces pedidas (0 si no aplica)
+        double avgActiveVoices = 0.0;
+        int blocks = 0;
+        double meanUs = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+        double p99BudgetPercent = 0.0; // p99 / duración del bloque
+        double nsPerVoiceSample = 0.0; // Media / (voces activas × samples); 0 si no aplica
+    };
+
+    explicit EngineBenchmark(const Config& config);
+
+    /** Ejecuta los suites seleccionados y devuelve un resultado por caso */
+    std::vector<Result> run();
+
+    /** Tabla legible en stdout */
+    static void printResults(const std::vector<Result>& results);
+
+    /** CSV (una fila por caso) para comparar entre commits */
+    static bool writeCsv(const std::vector<Result>& results, const juce::File& file);
+
+private:
+    //==============================================================================
+    static constexpr int WARMUP_BLOCKS = 8;
+
+    /** Tiempos por bloque pre-reservados: medir no debe allocar dentro del bucle */
+    struct BlockTimes
+    {
+        std::vector<juce::int64> ticks;
+        double activeVoiceSum = 0.0;
+
+        void prepare(int numBlocks) { ticks.clear(); ticks.reserve((size_t)numBlocks); activeVoiceSum = 0.0; }
+        void add(juce::int64 blockTicks, int activeVoices);
+    };
+
+    Config config;
+
+    bool suiteEnabled(const char* name) const;
+    int numBlocksFor(double sampleRate, int blockSize) const;
+    juce::String threadsVariant(const juce::String& variant) const; // "<variant> +Nt" con hilos de render
+
+    void runModalVoice(std::vector<Result>& results);
+    void runVoiceManager(std::vector<Result>& results);
+    void runPlateSynth(std::vector<Result>& results);
+    void runSynthesisEngine(std::vector<Result>& results);
+
+    /** Media, p99 y máximo (ordena times.ticks) */
+    static Result summarize(BlockTimes& times, const juce::String& suite, const juce::String& variant,
+                            double sampleRate, int blockSize, int voices, bool perVoice);
+};
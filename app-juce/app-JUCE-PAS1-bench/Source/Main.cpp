@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    Benchmark del motor de audio (ModalVoice, VoiceManager, PlateSynth,
+    SynthesisEngine): tiempo por bloque medio, p99 y máximo, y ns/voz/sample.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "EngineBenchmark.h"
+#include <iostream>
+
+//==============================================================================
+static void printUsage()
+{
+    std::cout << "Uso: app-JUCE-PAS1-bench [opciones]\n"
+                 "  --suite=<nombre>  voice | manager | plate | engine (default: todos)\n"
+                 "  --seconds=2.0     Audio renderizado por caso\n"
+                 "  --quick           Barrido reducido\n"
+                 "  --threads=0       Hilos auxiliares de render de voces (manager, engine)\n"
+                 "  --csv=<archivo>   Guardar resultados en CSV\n";
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    EngineBenchmark::Config config;
+    config.quick = args.containsOption("--quick");
+    if (args.containsOption("--seconds"))
+        config.seconds = args.getValueForOption("--seconds").getDoubleValue();
+    if (args.containsOption("--threads"))
+        config.threads = juce::jlimit(0, VoiceManager::MAX_RENDER_WORKERS, args.getValueForOption("--threads").getIntValue());
+    if (args.containsOption("--suite"))
+    {
+        config.suite = args.getValueForOption("--suite");
+        if (config.suite != "voice" && config.suite != "manager" && config.suite != "plate" && config.suite != "engine")
+        {
+            std::cerr << "Suite desconocido: " << config.suite << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    EngineBenchmark benchmark(config);
+    auto results = benchmark.run();
+    EngineBenchmark::printResults(results);
+
+    if (args.containsOption("--csv"))
+    {
+        juce::File csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--csv"));
+        if (!EngineBenchmark::writeCsv(results, csvFile))
+        {
+            std::cerr << "No se pudo escribir " << csvFile.getFullPathName() << std::endl;
+            return 1;
+        }
+        std::cout << "CSV: " << csvFile.getFullPathName() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include "OfflineRenderer.h"
+#include "OSCHitMapping.h"
+#include <algorithm>
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(const Settings& s)
+    : settings(s), pitchRandomGen(s.seed)
+{
+    settings.blockSize = juce::jlimit(16, 8192, settings.blockSize);
+    settings.numChannels = juce::jlimit(1, 8, settings.numChannels);
+
+    engine = std::make_unique<SynthesisEngine>();
+    engine->setVoicePoolSize(settings.voicePoolSize); // Antes de setMaxVoices: limita las voces
+    engine->setMaxVoices(settings.maxVoices);
+    engine->setLimiterLookAhead(settings.limiterLookAhead);
+    engine->setVoiceRenderThreads(settings.renderThreads, true);
+
+    // M4: mismos toggles que MainComponent
+    engine->setEnableM4Character(true);
+    engine->setEnableDensityCompensation(true);
+}
+
+//==============================================================================
+bool OfflineRenderer::loadEvents(const juce::File& ndjsonFile, std::vector<Event>& events, juce::String& error)
+{
+    if (!ndjsonFile.existsAsFile())
+    {
+        error = "No existe " + ndjsonFile.getFullPathName();
+        return false;
+    }
+
+    juce::StringArray lines;
+    ndjsonFile.readLines(lines);
+    events.clear();
+    events.reserve((size_t)lines.size());
+
+    for (const auto& line : lines)
+    {
+        if (line.trim().isEmpty())
+            continue;
+
+        // {"timestamp": 0.123, "osc_address": "/hit", "osc_args": [...], "wall_clock": "..."}
+        juce::var record = juce::JSON::parse(line);
+        if (!record.isObject())
+            continue;
+        const juce::var& address = record["osc_address"];
+        const juce::var& timestamp = record["timestamp"];
+        if (!address.isString() || !(timestamp.isDouble() || timestamp.isInt() || timestamp.isInt64()))
+            continue;
+
+        Event event;
+        event.time = (double)timestamp;
+        event.address = address.toString();
+        if (auto* args = record["osc_args"].getArray())
+            event.args = *args;
+        events.push_back(std::move(event));
+    }
+
+    // El registro es en orden de llegada; ordenar por si varios hilos escribieron intercalados
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event& a, const Event& b) { return a.time < b.time; });
+    return true;
+}
+
+//==============================================================================
+bool OfflineRenderer::render(const std::vector<Event>& events, const juce::File& outputFile, Stats& stats, juce::String& error)
+{
+    stats = Stats();
+    auto wallStart = juce::Time::getHighResolutionTicks();
+
+    outputFile.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(outputFile.createOutputStream());
+    if (stream == nullptr || !stream->openedOk())
+    {
+        error = "No se pudo abrir " + outputFile.getFullPathName();
+        return false;
+    }
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), settings.sampleRate,
+                                                                              (unsigned int)settings.numChannels,
+                                                                              settings.bitsPerSample, {}, 0));
+    if (writer == nullptr)
+    {
+        error = "Formato WAV no soportado (" + juce::String(settings.bitsPerSample) + " bits)";
+        return false;
+    }
+    stream.release(); // El writer es dueño del stream
+
+    engine->prepare(settings.sampleRate, settings.numChannels);
+    engine->reset();
+    hitAggregator.reset();
+    eventsDispatched = 0;
+
+    double lastEventTime = events.empty() ? 0.0 : events.back().time;
+    juce::int64 totalSamples = (juce::int64)std::ceil((juce::jmax(0.0, lastEventTime) + settings.tailSeconds) * settings.sampleRate);
+
+    juce::AudioBuffer<float> buffer(settings.numChannels, settings.blockSize);
+    const double windowSeconds = HitAggregator::WINDOW_MS * 0.001;
+    double nextWindowTime = windowSeconds;
+    size_t nextEvent = 0;
+    double ticksToSeconds = 1.0 / (double)juce::Time::getHighResolutionTicksPerSecond();
+    juce::int64 renderTicks = 0;
+    juce::int64 maxBlockTicks = 0;
+
+    for (juce::int64 pos = 0; pos < totalSamples; pos += settings.blockSize)
+    {
+        const int len = (int)juce::jmin((juce::int64)settings.blockSize, totalSamples - pos);
+        const double blockTime = (double)pos / settings.sampleRate;
+
+        // Eventos y cierres de ventana hasta el inicio del bloque, en orden temporal
+        for (;;)
+        {
+            bool eventDue = nextEvent < events.size() && events[nextEvent].time <= blockTime;
+            bool windowDue = settings.enableFusionAggregation && nextWindowTime <= blockTime;
+            if (!eventDue && !windowDue)
+                break;
+
+            if (eventDue && (!windowDue || events[nextEvent].time < nextWindowTime))
+            {
+                dispatch(events[nextEvent]);
+                nextEvent++;
+            }
+            else
+            {
+                flushAggregatorWindow();
+                nextWindowTime += windowSeconds;
+            }
+        }
+
+        buffer.clear();
+        auto blockStart = juce::Time::getHighResolutionTicks();
+        engine->renderNextBlock(buffer, 0, len);
+        auto blockTicks = juce::Time::getHighResolutionTicks() - blockStart;
+        renderTicks += blockTicks;
+        maxBlockTicks = juce::jmax(maxBlockTicks, blockTicks);
+
+        if (!writer->writeFromAudioSampleBuffer(buffer, 0, len))
+        {
+            error = "Error escribiendo " + outputFile.getFullPathName();
+            return false;
+        }
+    }
+    writer.reset(); // Cierra el WAV (cabecera con el tamaño final)
+
+    stats.eventsDispatched = eventsDispatched;
+    stats.hitsReceived = engine->getHitsReceived();
+    stats.hitsTriggered = engine->getHitsTriggered();
+    stats.hitsDiscarded = engine->getHitsDiscarded();
+    stats.blocksClipped = engine->getBlocksClippedCount();
+    stats.samplesRendered = totalSamples;
+    stats.audioSeconds = (double)totalSamples / settings.sampleRate;
+    stats.renderSeconds = (double)renderTicks * ticksToSeconds;
+    stats.wallSeconds = (double)(juce::Time::getHighResolutionTicks() - wallStart) * ticksToSeconds;
+    stats.maxBlockMs = (double)maxBlockTicks * ticksToSeconds * 1000.0;
+    stats.realtimeFactor = stats.renderSeconds > 0.0 ? stats.audioSeconds / stats.renderSeconds : 0.0;
+    return true;
+}
+
+//==============================================================================
+void OfflineRenderer::dispatch(const Event& event)
+{
+    if (event.address == "/hit")
+        dispatchHit(event.args);
+    else if (event.address == "/plate" && settings.enablePlateSynth)
+        dispatchPlate(event.args);
+    else if (event.address == "/state")
+        eventsDispatched += (event.args.size() == 3 && allNumeric(event.args)) ? 1 : 0; // Presence: solo se guarda en la app
+    // Direcciones de control (/test/*) y desconocidas: se ignoran
+}
+
+//==============================================================================
+void OfflineRenderer::dispatchHit(const juce::Array<juce::var>& args)
+{
+    // /hit id x y energy surface [seq count [t_us]]. En la grabación los hits tardíos ya vienen en orden
+    // de llegada: seq/count no se usan para descartar; t_us (sonda de latencia) no aplica offline.
+    if ((args.size() != 5 && args.size() != 7 && args.size() != 8) || !allNumeric(args))
+        return;
+
+    float x = juce::jlimit(0.0f, 1.0f, (float)args[1]);
+    float y = juce::jlimit(0.0f, 1.0f, (float)args[2]);
+    float energy = juce::jlimit(0.0f, 1.0f, (float)args[3]);
+    int surface = (int)args[4];
+    eventsDispatched++;
+
+    if (settings.enableFusionAggregation)
+    {
+        engine->incrementHitsReceived();
+        hitAggregator.addHit(x, y, energy, surface);
+        return;
+    }
+
+    auto mapping = OSCHitMapping::fromHit(y, energy, engine->getPitchRange(), pitchRandomDist(pitchRandomGen));
+    engine->triggerVoiceFromOSC(mapping.baseFreq, mapping.amplitude, mapping.damping, mapping.brightness,
+                                engine->getMetalness(), mapping.waveform, engine->getSubOscMix());
+}
+
+//==============================================================================
+void OfflineRenderer::dispatchPlate(const juce::Array<juce::var>& args)
+{
+    // /plate freq amp mode
+    if (args.size() != 3 || !allNumeric(args))
+        return;
+
+    float freq = juce::jlimit(20.0f, 2000.0f, (float)args[0]);
+    float amp = juce::jlimit(0.0f, 1.0f, (float)args[1]);
+    int mode = juce::jlimit(0, 7, (int)args[2]);
+    eventsDispatched++;
+    engine->triggerPlateFromOSC(freq, amp, mode);
+}
+
+//==============================================================================
+void OfflineRenderer::flushAggregatorWindow()
+{
+    FusedHitSnapshot snaps[HitAggregator::NUM_QUADRANTS];
+    int n = hitAggregator.closeWindow(snaps, HitAggregator::NUM_QUADRANTS);
+    float metalness = engine->getMetalness();
+    float subOscMix = engine->getSubOscMix();
+    for (int i = 0; i < n; i++)
+    {
+        snaps[i].metalness = metalness;
+        snaps[i].subOscMix = subOscMix;
+        engine->enqueueFusedSnapshot(snaps[i]);
+    }
+}
+
+//==============================================================================
+bool OfflineRenderer::allNumeric(const juce::Array<juce::var>& args)
+{
+    // JSON no distingue int32/float32: 1.0 puede llegar como 1
+    for (const auto& arg : args)
+        if (!(arg.isInt() || arg.isInt64() || arg.isDouble()))
+            return false;
+    return true;
+}
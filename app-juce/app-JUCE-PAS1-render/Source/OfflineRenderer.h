@@ -0,0 +1,92 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SynthesisEngine.h"
+#include "HitAggregator.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+//==============================================================================
+/**
+    Render offline (sin dispositivo de audio) de una sesión OSC grabada.
+
+    Lee el run.ndjson de MAAD-2-CALIB (un objeto por línea: timestamp, osc_address, osc_args),
+    reproduce /hit, /plate y /state con el mismo ruteo que MainComponent — incluida la
+    agregación de 20 ms, cuyos cierres de ventana se intercalan en la línea de tiempo — y
+    renderiza SynthesisEngine bloque a bloque a un WAV tan rápido como da la CPU.
+    Los eventos se entregan antes del primer bloque que empieza en o después de su timestamp,
+    como llegarían al audio thread en vivo.
+*/
+class OfflineRenderer
+{
+public:
+    //==============================================================================
+    /** Evento OSC grabado (timestamp en segundos desde el inicio de la sesión) */
+    struct Event
+    {
+        double time = 0.0;
+        juce::String address;
+        juce::Array<juce::var> args;
+    };
+
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int numChannels = 2;
+        int bitsPerSample = 24;
+        double tailSeconds = 2.0;   // Render tras el último evento (colas de voces y placa)
+        int maxVoices = 8;
+        int voicePoolSize = VoiceManager::DEFAULT_POOL_SIZE;
+        int renderThreads = 0;      // Hilos auxiliares de voces; esperan siempre al bloque (render reproducible)
+        bool enableFusionAggregation = true; // Mismo default que MainComponent
+        bool enablePlateSynth = false;       // Mismo default que MainComponent
+        bool limiterLookAhead = false;
+        juce::uint32 seed = 1;      // Variación de pitch del modo sin agregación (render reproducible)
+    };
+
+    struct Stats
+    {
+        int eventsDispatched = 0;
+        int hitsReceived = 0;
+        int hitsTriggered = 0;
+        int hitsDiscarded = 0;
+        int blocksClipped = 0;
+        juce::int64 samplesRendered = 0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;  // Solo renderNextBlock (sin escritura del WAV)
+        double wallSeconds = 0.0;    // Total incluida la escritura
+        double maxBlockMs = 0.0;
+        double realtimeFactor = 0.0; // audioSeconds / renderSeconds
+    };
+
+    //==============================================================================
+    explicit OfflineRenderer(const Settings& settings);
+
+    /** Carga y ordena por timestamp los eventos de un run.ndjson. Líneas no válidas se ignoran. */
+    static bool loadEvents(const juce::File& ndjsonFile, std::vector<Event>& events, juce::String& error);
+
+    /** Renderiza la sesión completa a outputFile (WAV; se sobrescribe) */
+    bool render(const std::vector<Event>& events, const juce::File& outputFile, Stats& stats, juce::String& error);
+
+private:
+    //==============================================================================
+    Settings settings;
+    std::unique_ptr<SynthesisEngine> engine; // En heap: colas y pool de voces pre-allocados son grandes
+    HitAggregator hitAggregator;
+    std::mt19937 pitchRandomGen;
+    std::uniform_real_distribution<float> pitchRandomDist{0.0f, 1.0f};
+    int eventsDispatched = 0;
+
+    //==============================================================================
+    /** Ruteo por dirección, como MainComponent::oscMessageReceived */
+    void dispatch(const Event& event);
+    void dispatchHit(const juce::Array<juce::var>& args);
+    void dispatchPlate(const juce::Array<juce::var>& args);
+
+    /** Cierre de ventana del agregador, como MainComponent::flushAggregatorWindow */
+    void flushAggregatorWindow();
+
+    static bool allNumeric(const juce::Array<juce::var>& args);
+};
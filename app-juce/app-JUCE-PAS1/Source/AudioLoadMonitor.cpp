@@ -0,0 +1,168 @@
+#include "AudioLoadMonitor.h"
+
+//==============================================================================
+namespace
+{
+    constexpr juce::uint32 BIN_PERMYRIAD = (juce::uint32)(AudioLoadMonitor::BIN_PERCENT * 100.0f);
+    constexpr juce::uint32 BUDGET_PERMYRIAD = 10000; // 100 % del bloque
+
+    template <typename T>
+    inline void incrementSingleWriter(std::atomic<T>& counter, T amount)
+    {
+        // Un solo escritor: load + store evita la instrucción lock de fetch_add en el audio thread
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+AudioLoadMonitor::AudioLoadMonitor()
+{
+    previousHistogram.assign((size_t)(NUM_STAGES * NUM_BINS), 0);
+    reset();
+}
+
+//==============================================================================
+void AudioLoadMonitor::prepare(double sampleRate)
+{
+    ticksPerSample = (double)juce::Time::getHighResolutionTicksPerSecond() / juce::jmax(1.0, sampleRate);
+    reset();
+}
+
+//==============================================================================
+void AudioLoadMonitor::recordBlock(const juce::int64* stageTicks, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    const double toPermyriad = (double)BUDGET_PERMYRIAD / (ticksPerSample * (double)numSamples);
+    juce::uint32 totalPermyriad = 0;
+
+    for (int s = 0; s < NUM_STAGES; s++)
+    {
+        double load = juce::jlimit(0.0, 4.0e9, (double)stageTicks[s] * toPermyriad);
+        const juce::uint32 p = (juce::uint32)load;
+        const int bin = (int)juce::jmin((juce::uint32)(NUM_BINS - 1), p / BIN_PERMYRIAD);
+
+        incrementSingleWriter(histogram[s][bin], (juce::uint32)1);
+        incrementSingleWriter(sumPermyriad[s], (juce::uint64)p);
+        if (p > maxPermyriad[s].load(std::memory_order_relaxed))
+            maxPermyriad[s].store(p, std::memory_order_relaxed);
+
+        if (s == Total)
+            totalPermyriad = p;
+    }
+
+    incrementSingleWriter(blocks, 1);
+    if (totalPermyriad > BUDGET_PERMYRIAD)
+        incrementSingleWriter(overruns, 1);
+}
+
+//==============================================================================
+AudioLoadMonitor::Snapshot AudioLoadMonitor::takeSnapshot()
+{
+    Snapshot snap;
+
+    // Un reset desde el snapshot anterior reinicia los contadores: la copia previa ya no vale
+    const juce::uint32 generation = resetGeneration.load(std::memory_order_acquire);
+    if (generation != seenGeneration)
+        clearPrevious();
+
+    snap.totalBlocks = blocks.load(std::memory_order_relaxed);
+    snap.totalOverruns = overruns.load(std::memory_order_relaxed);
+    snap.blocks = snap.totalBlocks - previousBlocks;
+    snap.overruns = snap.totalOverruns - previousOverruns;
+    previousBlocks = snap.totalBlocks;
+    previousOverruns = snap.totalOverruns;
+
+    for (int s = 0; s < NUM_STAGES; s++)
+    {
+        // Intervalo = histograma actual - copia anterior (los contadores solo crecen)
+        juce::uint32 counts[NUM_BINS];
+        juce::uint64 n = 0;
+        for (int b = 0; b < NUM_BINS; b++)
+        {
+            juce::uint32 current = histogram[s][b].load(std::memory_order_relaxed);
+            juce::uint32& previous = previousHistogram[(size_t)(s * NUM_BINS + b)];
+            counts[b] = current - previous;
+            previous = current;
+            n += counts[b];
+        }
+
+        juce::uint64 sum = sumPermyriad[s].load(std::memory_order_relaxed);
+        juce::uint64 deltaSum = sum - previousSum[s];
+        previousSum[s] = sum;
+
+        // El máximo es por intervalo: un bloque que escriba entre load y exchange pasa al siguiente
+        float maxPercent = (float)maxPermyriad[s].exchange(0, std::memory_order_relaxed) * 0.01f;
+
+        StageStats& stats = snap.stages[s];
+        if (n == 0)
+            continue;
+
+        stats.meanPercent = (float)((double)deltaSum / (double)n * 0.01);
+        stats.maxPercent = maxPercent;
+
+        // p99: borde superior del primer bin que acumula el 99 % (último bin abierto: máximo)
+        const juce::uint64 target = (n * 99 + 99) / 100;
+        juce::uint64 cumulative = 0;
+        int bin = 0;
+        for (; bin < NUM_BINS - 1; bin++)
+        {
+            cumulative += counts[bin];
+            if (cumulative >= target)
+                break;
+        }
+        float upperEdge = (float)(bin + 1) * BIN_PERCENT;
+        stats.p99Percent = (bin == NUM_BINS - 1) ? maxPercent : juce::jmin(upperEdge, maxPercent);
+    }
+
+    // Un reset en curso o solapado con la lectura deja deltas sin sentido: se descarta el intervalo
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const juce::uint32 generationAfter = resetGeneration.load(std::memory_order_relaxed);
+    if (generationAfter != generation || (generation & 1u) != 0)
+    {
+        clearPrevious();
+        seenGeneration = generationAfter; // Si sigue impar, el siguiente snapshot vuelve a vaciar
+        return {};
+    }
+    seenGeneration = generation;
+
+    return snap;
+}
+
+//==============================================================================
+void AudioLoadMonitor::reset()
+{
+    // Solo estado del escritor: la copia del lector es del message thread (ver takeSnapshot)
+    const juce::uint32 generation = resetGeneration.load(std::memory_order_relaxed);
+    resetGeneration.store(generation + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int s = 0; s < NUM_STAGES; s++)
+    {
+        for (int b = 0; b < NUM_BINS; b++)
+            histogram[s][b].store(0, std::memory_order_relaxed);
+        sumPermyriad[s].store(0, std::memory_order_relaxed);
+        maxPermyriad[s].store(0, std::memory_order_relaxed);
+    }
+    blocks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+
+    resetGeneration.store(generation + 2, std::memory_order_release);
+}
+
+//==============================================================================
+void AudioLoadMonitor::clearPrevious()
+{
+    std::fill(previousHistogram.begin(), previousHistogram.end(), 0u);
+    std::fill(std::begin(previousSum), std::end(previousSum), (juce::uint64)0);
+    previousBlocks = 0;
+    previousOverruns = 0;
+}
+
+//==============================================================================
+const char* AudioLoadMonitor::getStageName(int stage)
+{
+    static const char* names[NUM_STAGES] = { "queue", "voices", "plate", "master", "total" };
+    return (stage >= 0 && stage < NUM_STAGES) ? names[stage] : "";
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+    Carga del audio thread por etapa de renderNextBlock (drenado de colas, voces, plate, master)
+    y total, como % del presupuesto del bloque (numSamples / sampleRate).
+
+    El audio thread registra un bloque con recordBlock(): un bin de histograma por etapa, suma y
+    máximo, y overrun si el total supera el presupuesto. Un solo escritor: todo son load/store
+    relaxed sobre atomics, sin RMW, locks ni allocations. El message thread (un solo lector) toma
+    snapshots con takeSnapshot(): media, p99 y máximo del intervalo desde el snapshot anterior,
+    restando la copia previa del histograma.
+
+    reset() corre en el thread del dispositivo (prepare/releaseResources) y solo toca los atomics
+    del escritor, envuelto en una generación impar/par (seqlock): el lector descarta el intervalo
+    que se solape con un reset y vacía su propia copia al ver una generación nueva.
+*/
+class AudioLoadMonitor
+{
+public:
+    //==============================================================================
+    enum Stage
+    {
+        Queue = 0,  // processEventQueue
+        Voices,     // VoiceManager + ResonatorBank (incluye la espera a los workers)
+        Plate,      // PlateSynth
+        Master,     // Mezcla, trim, clipper/limiter y medidor
+        Total,      // renderNextBlock completo
+        NUM_STAGES
+    };
+
+    static constexpr int NUM_BINS = 512;            // Último bin: >= (NUM_BINS - 1) × BIN_PERCENT
+    static constexpr float BIN_PERCENT = 0.25f;     // Resolución del p99
+
+    struct StageStats
+    {
+        float meanPercent = 0.0f;
+        float p99Percent = 0.0f;
+        float maxPercent = 0.0f;
+    };
+
+    struct Snapshot
+    {
+        StageStats stages[NUM_STAGES];
+        int blocks = 0;         // Bloques del intervalo
+        int overruns = 0;       // Bloques del intervalo con total > 100 %
+        int totalBlocks = 0;    // Desde reset()
+        int totalOverruns = 0;
+    };
+
+    AudioLoadMonitor();
+
+    /** Ticks de alta resolución por sample y reset (fuera del audio thread) */
+    void prepare(double sampleRate);
+
+    /** Registra un bloque: ticks por etapa (stageTicks[Total] = bloque completo). RT-safe. */
+    void recordBlock(const juce::int64* stageTicks, int numSamples);
+
+    /** Estadísticas desde el snapshot anterior (message thread, un solo lector) */
+    Snapshot takeSnapshot();
+
+    /** Vacía histogramas y contadores del escritor (thread del dispositivo, con el audio parado) */
+    void reset();
+
+    static const char* getStageName(int stage);
+
+private:
+    //==============================================================================
+    double ticksPerSample = 1.0;
+
+    // Escritos solo por el audio thread
+    std::atomic<juce::uint32> histogram[NUM_STAGES][NUM_BINS];
+    std::atomic<juce::uint64> sumPermyriad[NUM_STAGES]; // Σ carga × 10000
+    std::atomic<juce::uint32> maxPermyriad[NUM_STAGES]; // El lector lo pone a 0 en cada snapshot
+    std::atomic<int> blocks{0};
+    std::atomic<int> overruns{0};
+    std::atomic<juce::uint32> resetGeneration{0}; // Impar mientras reset() vacía los contadores
+
+    // Copia del lector para restar intervalos (message thread)
+    std::vector<juce::uint32> previousHistogram;
+    juce::uint64 previousSum[NUM_STAGES] = {};
+    int previousBlocks = 0;
+    int previousOverruns = 0;
+    juce::uint32 seenGeneration = 0;
+
+    void clearPrevious();
+};
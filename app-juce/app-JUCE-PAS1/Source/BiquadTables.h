@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+//==============================================================================
+/**
+    Tabla de sin/cos compartida para el diseño de biquads (ModalVoice, FormantFilter, PlateSynth).
+
+    w = 2*pi*freq/sampleRate en [0, pi] se resuelve por tabla con interpolación lineal
+    (TABLE_SIZE puntos: error < 1e-7, por debajo de la precisión float de los coeficientes),
+    así triggers y barridos de parámetros no hacen sin/cos en el audio thread.
+    La tabla se construye en la inicialización estática (antes de abrir el audio device) y es de
+    solo lectura: el lookup no tiene guards ni branches más allá del recorte del índice.
+*/
+class BiquadTables
+{
+public:
+    static constexpr int TABLE_SIZE = 4096;
+
+    /** sin(w) y cos(w) para w en [0, pi] (fuera de rango se recorta). RT-safe. */
+    static void sinCos(float w, float& sinw, float& cosw)
+    {
+        float pos = juce::jlimit(0.0f, (float)TABLE_SIZE, w * INDEX_SCALE);
+        int i = juce::jmin((int)pos, TABLE_SIZE - 1);
+        float frac = pos - (float)i;
+        sinw = table.sinTable[i] + frac * (table.sinTable[i + 1] - table.sinTable[i]);
+        cosw = table.cosTable[i] + frac * (table.cosTable[i + 1] - table.cosTable[i]);
+    }
+
+    /** w normalizada para freq (Hz) a sampleRate */
+    static float omega(float freq, double sampleRate)
+    {
+        return 2.0f * juce::MathConstants<float>::pi * freq / (float)sampleRate;
+    }
+
+private:
+    static constexpr float INDEX_SCALE = (float)TABLE_SIZE / juce::MathConstants<float>::pi;
+
+    struct Table
+    {
+        float sinTable[TABLE_SIZE + 1];
+        float cosTable[TABLE_SIZE + 1];
+
+        Table()
+        {
+            for (int i = 0; i <= TABLE_SIZE; i++)
+            {
+                double w = juce::MathConstants<double>::pi * (double)i / (double)TABLE_SIZE;
+                sinTable[i] = (float)std::sin(w);
+                cosTable[i] = (float)std::cos(w);
+            }
+        }
+    };
+
+    static inline const Table table;
+};
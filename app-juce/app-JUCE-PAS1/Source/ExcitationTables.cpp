@@ -0,0 +1,183 @@
+#include "ExcitationTables.h"
+
+//==============================================================================
+ExcitationTables::ExcitationTables()
+{
+    prepare(44100.0);
+}
+
+//==============================================================================
+void ExcitationTables::prepare(double sampleRate)
+{
+    // Semilla fija: mismas realizaciones de ruido en cada prepare (render reproducible)
+    NoiseGenerator noiseGen(0x5eed);
+
+    for (int v = 0; v < NUM_LENGTH_VARIANTS; v++)
+    {
+        // Duración variable: 4-8ms (más corta = más aguda, más metálica)
+        float durationMs = 4.0f + 4.0f * (float)v / (float)(NUM_LENGTH_VARIANTS - 1);
+        int length = juce::jlimit(1, MAX_LENGTH, (int)(durationMs * 0.001f * sampleRate));
+        lengths[v] = length;
+
+        for (int n = 0; n < NUM_NOISE_VARIANTS; n++)
+            fillNoise(noiseTables[v][n], length, noiseGen);
+        fillSine(waveTables[1][v], length);
+        fillSquare(waveTables[2][v], length);
+        fillSaw(waveTables[3][v], length);
+        fillTriangle(waveTables[4][v], length);
+        fillClick(waveTables[5][v], length);
+        fillPulse(waveTables[6][v], length);
+        juce::FloatVectorOperations::clear(waveTables[NOISE_WAVEFORM][v], MAX_LENGTH);
+
+        for (int n = 0; n < NUM_NOISE_VARIANTS; n++)
+            applyBurstEnvelope(noiseTables[v][n], length);
+        for (int w = 1; w < NUM_WAVEFORMS; w++)
+            applyBurstEnvelope(waveTables[w][v], length);
+    }
+}
+
+//==============================================================================
+void ExcitationTables::fillNoise(float* table, int length, NoiseGenerator& noiseGen)
+{
+    // Generar excitación con más contenido de alta frecuencia para timbre metálico "coin cascade"
+    // Aumentar presencia de ruido filtrado en el ataque para reforzar textura granular
+    float whiteNoise[MAX_LENGTH];
+    noiseGen.fill(whiteNoise, length, 1.25f); // -1.25 a 1.25 (aumentado para más presencia)
+    float prevSample = 0.0f;
+    float prevDiff = 0.0f;
+
+    for (int i = 0; i < length; i++)
+    {
+        float noise = whiteNoise[i];
+
+        // Diferenciación doble (high-pass más agresivo): click más agudo y metálico
+        float diff = noise - prevSample;
+        float diff2 = diff - prevDiff;
+        prevSample = noise;
+        prevDiff = diff;
+
+        // Envolvente con raíz cuadrada: mantiene más energía en el ataque
+        float env = std::sqrt(1.0f - ((float)i / (float)length));
+
+        // Mezclar señal diferenciada simple y doble para textura más rica
+        float mixed = diff * 0.7f + diff2 * 0.3f;
+        table[i] = mixed * env * 2.0f; // Amplificado para más presencia
+    }
+}
+
+//==============================================================================
+void ExcitationTables::fillSine(float* table, int length)
+{
+    // Sinusoidal suave: un ciclo completo de seno con envolvente cuadrática
+    const float twoPi = 2.0f * juce::MathConstants<float>::pi;
+
+    for (int i = 0; i < length; i++)
+    {
+        float phase = (float)i / (float)length * twoPi;
+        float env = 1.0f - ((float)i / (float)length);
+        table[i] = std::sin(phase) * env * env * 0.8f;
+    }
+}
+
+//==============================================================================
+void ExcitationTables::fillSquare(float* table, int length)
+{
+    // Cuadrada agresiva (2 ciclos), band-limited: armónicos impares bajo Nyquist
+    const float cycles = 2.0f;
+    const float twoPi = 2.0f * juce::MathConstants<float>::pi;
+    int maxHarmonic = juce::jmax(1, (int)((float)length / (2.0f * cycles)));
+
+    for (int i = 0; i < length; i++)
+    {
+        float phase = (float)i / (float)length * cycles;
+        float square = 0.0f;
+        for (int k = 1; k <= maxHarmonic; k += 2)
+            square += std::sin(twoPi * (float)k * phase) / (float)k;
+        square *= 4.0f / juce::MathConstants<float>::pi;
+
+        float env = 1.0f - ((float)i / (float)length);
+        table[i] = square * env * env * 0.7f;
+    }
+}
+
+//==============================================================================
+void ExcitationTables::fillSaw(float* table, int length)
+{
+    // Diente de sierra descendente (2 ciclos), band-limited: 1 - 2p = Σ 2 sin(2πkp) / (πk)
+    const float cycles = 2.0f;
+    const float twoPi = 2.0f * juce::MathConstants<float>::pi;
+    int maxHarmonic = juce::jmax(1, (int)((float)length / (2.0f * cycles)));
+
+    for (int i = 0; i < length; i++)
+    {
+        float phase = (float)i / (float)length * cycles;
+        float saw = 0.0f;
+        for (int k = 1; k <= maxHarmonic; k++)
+            saw += std::sin(twoPi * (float)k * phase) / (float)k;
+        saw *= 2.0f / juce::MathConstants<float>::pi;
+
+        float env = 1.0f - ((float)i / (float)length);
+        table[i] = saw * env * env * 0.6f;
+    }
+}
+
+//==============================================================================
+void ExcitationTables::fillTriangle(float* table, int length)
+{
+    // Triangular suave (2 ciclos, empieza en 1), band-limited: Σ 8 cos(2πkp) / (πk)² impares
+    const float cycles = 2.0f;
+    const float twoPi = 2.0f * juce::MathConstants<float>::pi;
+    const float pi = juce::MathConstants<float>::pi;
+    int maxHarmonic = juce::jmax(1, (int)((float)length / (2.0f * cycles)));
+
+    for (int i = 0; i < length; i++)
+    {
+        float phase = (float)i / (float)length * cycles;
+        float triangle = 0.0f;
+        for (int k = 1; k <= maxHarmonic; k += 2)
+            triangle += std::cos(twoPi * (float)k * phase) / (float)(k * k);
+        triangle *= 8.0f / (pi * pi);
+
+        float env = 1.0f - ((float)i / (float)length);
+        table[i] = triangle * env * env * 0.7f;
+    }
+}
+
+//==============================================================================
+void ExcitationTables::fillClick(float* table, int length)
+{
+    // Impulso delta percusivo: solo los primeros samples (4 máximo) tienen señal
+    int clickLength = juce::jmin(4, length);
+
+    for (int i = 0; i < length; i++)
+    {
+        float env = 1.0f - ((float)i / (float)clickLength);
+        table[i] = (i < clickLength) ? env * 2.0f : 0.0f; // Alto para ser percusivo
+    }
+}
+
+//==============================================================================
+void ExcitationTables::fillPulse(float* table, int length)
+{
+    // Pulso estrecho muy agudo tipo "tick": positivo y negativo corto (balance)
+    int pulseWidth = juce::jmin(2, length / 4);
+
+    for (int i = 0; i < length; i++)
+    {
+        if (i < pulseWidth)
+            table[i] = 1.5f;
+        else if (i < pulseWidth * 2)
+            table[i] = -1.5f;
+        else
+            table[i] = 0.0f;
+    }
+}
+
+//==============================================================================
+void ExcitationTables::applyBurstEnvelope(float* table, int length)
+{
+    for (int i = 0; i < length; i++)
+        table[i] *= 1.0f - ((float)i / (float)length);
+    for (int i = length; i < MAX_LENGTH; i++)
+        table[i] = 0.0f;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseGenerator.h"
+
+//==============================================================================
+/**
+    Banco de excitaciones precalculadas para los triggers de ModalVoice.
+
+    Una tabla por forma de onda y variante de duración (4–8 ms), con la envolvente del burst ya
+    aplicada; Noise tiene además NUM_NOISE_VARIANTS realizaciones por duración. Square/Saw/Triangle
+    se sintetizan por suma de armónicos bajo Nyquist (band-limited). Se construye en prepare()
+    (fuera del audio thread) y se comparte entre todas las voces: un trigger solo elige índices
+    y guarda un puntero, sin Random por sample ni trigonometría.
+*/
+class ExcitationTables
+{
+public:
+    static constexpr int MAX_LENGTH = 128;          // Máximo del burst (igual que el buffer anterior por voz)
+    static constexpr int NUM_WAVEFORMS = 7;         // ModalVoice::ExcitationWaveform
+    static constexpr int NUM_LENGTH_VARIANTS = 8;   // Duraciones repartidas en 4–8 ms
+    static constexpr int NUM_NOISE_VARIANTS = 16;   // Realizaciones de ruido por duración
+
+    ExcitationTables();
+
+    /** Construye todas las tablas para el sample rate (message thread / prepareToPlay) */
+    void prepare(double sampleRate);
+
+    /** Tabla de la forma de onda (índice de ExcitationWaveform) y variantes. RT-safe. */
+    const float* getTable(int waveform, int lengthVariant, int noiseVariant) const
+    {
+        if (waveform == NOISE_WAVEFORM)
+            return noiseTables[lengthVariant][noiseVariant];
+        return waveTables[waveform][lengthVariant];
+    }
+
+    /** Longitud en samples de la variante de duración */
+    int getLength(int lengthVariant) const { return lengths[lengthVariant]; }
+
+private:
+    static constexpr int NOISE_WAVEFORM = 0;
+
+    int lengths[NUM_LENGTH_VARIANTS];
+    float waveTables[NUM_WAVEFORMS][NUM_LENGTH_VARIANTS][MAX_LENGTH]; // Fila de Noise sin usar
+    float noiseTables[NUM_LENGTH_VARIANTS][NUM_NOISE_VARIANTS][MAX_LENGTH];
+
+    //==============================================================================
+    static void fillNoise(float* table, int length, NoiseGenerator& noiseGen);
+    static void fillSine(float* table, int length);
+    static void fillSquare(float* table, int length);
+    static void fillSaw(float* table, int length);
+    static void fillTriangle(float* table, int length);
+    static void fillClick(float* table, int length);
+    static void fillPulse(float* table, int length);
+
+    /** Envolvente lineal de lectura del burst (1 → 0), horneada en la tabla */
+    static void applyBurstEnvelope(float* table, int length);
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 /**
  * Snapshot de un evento fusionado (varios hits en ventana 20 ms por cuadrante).
  * Escrito en message thread, leído en audio thread (cola lock-free).
@@ -18,4 +20,6 @@ struct FusedHitSnapshot
     float gainL       = 1.0f;  // constant-power pan
     float gainR       = 1.0f;
     int   quadrant    = -1;    // 0..3 para reserva por cuadrante
+    unsigned int enqueueTimeMs = 0; // Time::getMillisecondCounter() al encolar (detección de eventos viejos)
+    int64_t probeSendNs = 0;   // Sonda de latencia: t_ns del /hit más antiguo que contiene (0 = sin sonda)
 };
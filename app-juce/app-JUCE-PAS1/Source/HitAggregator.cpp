@@ -12,7 +12,7 @@ int HitAggregator::quadrantFromXY(float x, float y)
     return qx + 2 * qy;
 }
 
-void HitAggregator::addHit(float x, float y, float impactIntensity, int surface)
+void HitAggregator::addHit(float x, float y, float impactIntensity, int surface, int64_t probeSendNs)
 {
     float a = std::pow(std::max(0.0f, impactIntensity), 1.5f);
     double w = static_cast<double>(a * a);
@@ -30,6 +30,8 @@ void HitAggregator::addHit(float x, float y, float impactIntensity, int surface)
         b.countEdges++;
     else if (surface == -1)
         b.countPP++;
+    if (probeSendNs > 0 && (b.probeSendNs == 0 || probeSendNs < b.probeSendNs))
+        b.probeSendNs = probeSendNs;
 }
 
 int HitAggregator::closeWindow(FusedHitSnapshot* out, int maxCount)
@@ -42,6 +44,7 @@ int HitAggregator::closeWindow(FusedHitSnapshot* out, int maxCount)
 
         FusedHitSnapshot& s = out[n++];
         s.quadrant = q;
+        s.probeSendNs = b.probeSendNs;
         float E = static_cast<float>(b.sumE);
         float aOut = std::sqrt(E);
         aOut = std::min(1.0f, aOut);
@@ -116,5 +119,6 @@ void HitAggregator::reset()
         buckets[q].count = 0;
         buckets[q].countEdges = 0;
         buckets[q].countPP = 0;
+        buckets[q].probeSendNs = 0;
     }
 }
@@ -16,8 +16,9 @@ public:
 
     HitAggregator() { reset(); }
 
-    /** Añade un hit (message thread). impactIntensity 0..1, surface 0..3 bordes, -1 p-p. */
-    void addHit(float x, float y, float impactIntensity, int surface);
+    /** Añade un hit (message thread). impactIntensity 0..1, surface 0..3 bordes, -1 p-p.
+     *  probeSendNs: t_ns del /hit instrumentado (0 = sin sonda); el snapshot conserva el más antiguo. */
+    void addHit(float x, float y, float impactIntensity, int surface, int64_t probeSendNs = 0);
 
     /**
      * Cierra la ventana actual y escribe en out hasta maxCount snapshots (no vacíos).
@@ -39,6 +40,7 @@ private:
         int count = 0;
         int countEdges = 0;
         int countPP = 0;
+        int64_t probeSendNs = 0;
     };
     QuadBucket buckets[NUM_QUADRANTS];
 };
@@ -0,0 +1,198 @@
+#include "LookAheadLimiter.h"
+
+// process() corre en el audio thread: sin locks ni allocations (todo se dimensiona en prepare()).
+
+//==============================================================================
+LookAheadLimiter::LookAheadLimiter()
+{
+    prepare(44100.0);
+}
+
+//==============================================================================
+void LookAheadLimiter::prepare(double sampleRate)
+{
+    currentSampleRate = sampleRate;
+
+    // Dimensionar para el look-ahead máximo: cambiar el look-ahead después no realoca
+    int maxLookahead = juce::jmax(1, (int)std::ceil(MAX_LOOKAHEAD_MS * 0.001 * sampleRate));
+    int delaySize = juce::nextPowerOfTwo(maxLookahead + 2);
+    for (auto& line : delayLines)
+        line.assign((size_t)delaySize, 0.0f);
+    delayMask = delaySize - 1;
+
+    int holdSize = juce::nextPowerOfTwo(maxLookahead + 2);
+    holdValues.assign((size_t)holdSize, 1.0f);
+    holdTimes.assign((size_t)holdSize, 0);
+    holdMask = holdSize - 1;
+
+    boxRing.assign((size_t)maxLookahead, 1.0f);
+
+    float releaseSamples = DEFAULT_RELEASE_MS * 0.001f * (float)sampleRate;
+    releaseCoeff = 1.0f - std::exp(-1.0f / juce::jmax(1.0f, releaseSamples));
+
+    configure(lookaheadMs.load());
+}
+
+//==============================================================================
+void LookAheadLimiter::setLookaheadMs(float ms)
+{
+    lookaheadMs.store(juce::jlimit(0.25f, MAX_LOOKAHEAD_MS, ms));
+}
+
+//==============================================================================
+void LookAheadLimiter::configure(float ms)
+{
+    appliedLookaheadMs = ms;
+    lookahead = juce::jlimit(1, (int)boxRing.size(), juce::roundToInt(ms * 0.001 * currentSampleRate));
+
+    // x[m] limita la ganancia en los instantes m..m+2 (pico propio y dos puntos medios vecinos):
+    // con retraso L+1 y hold L+2 toda la media móvil que llega a x[m] ya los ha visto
+    delaySamples = lookahead + 1;
+    holdLength = lookahead + 2;
+    latencySamples.store(delaySamples);
+    reset();
+}
+
+//==============================================================================
+void LookAheadLimiter::reset()
+{
+    for (auto& line : delayLines)
+        std::fill(line.begin(), line.end(), 0.0f);
+    writePos = 0;
+    for (auto& channelHistory : history)
+        std::fill(std::begin(channelHistory), std::end(channelHistory), 0.0f);
+
+    holdHead = 0;
+    holdCount = 0;
+    sampleCounter = 0;
+
+    std::fill(boxRing.begin(), boxRing.end(), 1.0f);
+    boxPos = 0;
+    boxSum = (double)lookahead;
+    envelope = 1.0f;
+}
+
+//==============================================================================
+bool LookAheadLimiter::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, float ceiling)
+{
+    // Cambio de look-ahead: se aplica aquí (audio thread) para no tocar el estado desde la UI
+    float requestedMs = lookaheadMs.load(std::memory_order_relaxed);
+    if (requestedMs != appliedLookaheadMs)
+        configure(requestedMs);
+
+    int numChannels = buffer.getNumChannels();
+    int limitedChannels = juce::jmin(numChannels, MAX_CHANNELS);
+    bool clamped = false;
+    const float reportLevel = ceiling * 1.0001f; // Error de redondeo de gain × x no cuenta como recorte
+
+    for (int pos = 0; pos < numSamples; pos += CHUNK)
+    {
+        const int len = juce::jmin(CHUNK, numSamples - pos);
+
+        float* channels[MAX_CHANNELS];
+        for (int channel = 0; channel < limitedChannels; channel++)
+            channels[channel] = buffer.getWritePointer(channel, startSample + pos);
+
+        float requiredGain[CHUNK];
+        float gain[CHUNK];
+        computeRequiredGain(channels, limitedChannels, len, ceiling, requiredGain);
+        computeGain(requiredGain, gain, len);
+
+        // Audio retrasado × ganancia; el recorte al techo solo actúa si la estimación se quedó corta
+        for (int channel = 0; channel < limitedChannels; channel++)
+        {
+            float* data = channels[channel];
+            float* line = delayLines[channel].data();
+            int wp = writePos;
+            float peak = 0.0f;
+            for (int i = 0; i < len; i++)
+            {
+                line[wp] = data[i];
+                float y = line[(wp - delaySamples) & delayMask] * gain[i];
+                wp = (wp + 1) & delayMask;
+                peak = juce::jmax(peak, std::abs(y));
+                data[i] = juce::jlimit(-ceiling, ceiling, y);
+            }
+            clamped = clamped || peak > reportLevel;
+        }
+        writePos = (writePos + len) & delayMask;
+    }
+
+    // Canales por encima de MAX_CHANNELS: sin delay line, solo recorte
+    for (int channel = limitedChannels; channel < numChannels; channel++)
+    {
+        float* data = buffer.getWritePointer(channel, startSample);
+        float peak = 0.0f;
+        for (int i = 0; i < numSamples; i++)
+        {
+            peak = juce::jmax(peak, std::abs(data[i]));
+            data[i] = juce::jlimit(-ceiling, ceiling, data[i]);
+        }
+        clamped = clamped || peak > reportLevel;
+    }
+
+    return clamped;
+}
+
+//==============================================================================
+void LookAheadLimiter::computeRequiredGain(const float* const* channels, int numChannels, int numSamples,
+                                           float ceiling, float* requiredGain)
+{
+    // Pico estimado enlazado entre canales: max(|x[n]|, |punto medio entre x[n-2] y x[n-1]|),
+    // punto medio por interpolación de 4 taps (-1, 9, 9, -1) / 16 ≈ sobremuestreo 2x
+    float peak[CHUNK];
+    std::fill(peak, peak + numSamples, 0.0f);
+
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        float extended[CHUNK + 3];
+        std::copy(std::begin(history[channel]), std::end(history[channel]), extended);
+        std::copy(channels[channel], channels[channel] + numSamples, extended + 3);
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            float midpoint = (9.0f * (extended[i + 1] + extended[i + 2]) - extended[i] - extended[i + 3]) * 0.0625f;
+            peak[i] = juce::jmax(peak[i], std::abs(extended[i + 3]), std::abs(midpoint));
+        }
+
+        std::copy(extended + numSamples, extended + numSamples + 3, history[channel]);
+    }
+
+    for (int i = 0; i < numSamples; i++)
+        requiredGain[i] = juce::jmin(1.0f, ceiling / juce::jmax(peak[i], 1.0e-9f));
+}
+
+//==============================================================================
+void LookAheadLimiter::computeGain(const float* requiredGain, float* gain, int numSamples)
+{
+    const float invLookahead = 1.0f / (float)lookahead;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        // Mínimo deslizante sobre holdLength samples (cola monotónica, O(1) amortizado)
+        float value = requiredGain[i];
+        while (holdCount > 0 && holdValues[(size_t)((holdHead + holdCount - 1) & holdMask)] >= value)
+            holdCount--;
+        int back = (holdHead + holdCount) & holdMask;
+        holdValues[(size_t)back] = value;
+        holdTimes[(size_t)back] = sampleCounter;
+        holdCount++;
+        if (holdTimes[(size_t)holdHead] <= sampleCounter - holdLength)
+        {
+            holdHead = (holdHead + 1) & holdMask;
+            holdCount--;
+        }
+        float held = holdValues[(size_t)holdHead];
+        sampleCounter++;
+
+        // Ataque instantáneo (el look-ahead lo suaviza), release exponencial
+        envelope = held < envelope ? held : envelope + (held - envelope) * releaseCoeff;
+
+        // Media móvil de L samples: la ganancia baja en rampa durante el look-ahead
+        boxSum += (double)(envelope - boxRing[(size_t)boxPos]);
+        boxRing[(size_t)boxPos] = envelope;
+        if (++boxPos == lookahead)
+            boxPos = 0;
+        gain[i] = juce::jmin(1.0f, (float)boxSum * invLookahead);
+    }
+}
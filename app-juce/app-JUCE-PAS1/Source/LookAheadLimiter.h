@@ -0,0 +1,87 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Limiter look-ahead de picos (estimación true-peak) para el master bus.
+
+    Detección vectorizada por segmento: pico por sample y estimación del pico inter-sample
+    (interpolación de 4 taps en el punto medio), enlazados entre canales. La ganancia requerida
+    pasa por un mínimo deslizante (hold), release exponencial y una media móvil de la longitud
+    del look-ahead, con el audio retrasado lo mismo: la ganancia llega al valor necesario antes
+    del pico, sin distorsión por recorte. Un recorte final al techo cubre el error de estimación.
+    Delay lines y colas pre-allocadas en prepare(); process() es RT-safe.
+*/
+class LookAheadLimiter
+{
+public:
+    //==============================================================================
+    static constexpr int MAX_CHANNELS = 8;             // Canales extra: solo recorte al techo (sin delay)
+    static constexpr float DEFAULT_LOOKAHEAD_MS = 1.5f;
+    static constexpr float MAX_LOOKAHEAD_MS = 5.0f;
+    static constexpr float DEFAULT_RELEASE_MS = 60.0f;
+
+    LookAheadLimiter();
+
+    /** Pre-alloca delay lines para MAX_LOOKAHEAD_MS a sampleRate y resetea (fuera del audio thread) */
+    void prepare(double sampleRate);
+
+    /** Look-ahead en ms (0.25..MAX_LOOKAHEAD_MS). Thread-safe; se aplica al inicio del siguiente process(). */
+    void setLookaheadMs(float ms);
+    float getLookaheadMs() const { return lookaheadMs.load(std::memory_order_relaxed); }
+
+    /** Latencia añadida en samples (look-ahead + 1 de la estimación inter-sample) */
+    int getLatencySamples() const { return latencySamples.load(std::memory_order_relaxed); }
+
+    /** Limita in-place al techo (ganancia lineal). Devuelve true si el recorte de seguridad actuó. RT-safe. */
+    bool process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, float ceiling);
+
+    /** Vacía delay lines y estado de ganancia */
+    void reset();
+
+private:
+    //==============================================================================
+    static constexpr int CHUNK = 256;    // Segmento de detección (buffers en stack)
+
+    double currentSampleRate = 44100.0;
+    std::atomic<float> lookaheadMs{DEFAULT_LOOKAHEAD_MS};
+    std::atomic<int> latencySamples{0};
+    float appliedLookaheadMs = -1.0f;
+
+    int lookahead = 1;      // L: longitud de la media móvil
+    int holdLength = 3;     // L + 2: ventana del mínimo deslizante
+    int delaySamples = 2;   // L + 1: retraso del audio (el punto medio estimado cae 1.5 samples atrás)
+    float releaseCoeff = 0.0f;
+
+    // Delay lines por canal (potencia de 2) y últimas 3 entradas para la estimación inter-sample
+    std::vector<float> delayLines[MAX_CHANNELS];
+    int delayMask = 0;
+    int writePos = 0;
+    float history[MAX_CHANNELS][3] = {};
+
+    // Mínimo deslizante: cola monotónica circular (valor, instante)
+    std::vector<float> holdValues;
+    std::vector<juce::int64> holdTimes;
+    int holdMask = 0;
+    int holdHead = 0, holdCount = 0;
+    juce::int64 sampleCounter = 0;
+
+    // Media móvil de la ganancia suavizada
+    std::vector<float> boxRing;
+    int boxPos = 0;
+    double boxSum = 0.0;
+    float envelope = 1.0f;
+
+    //==============================================================================
+    /** Recalcula L/hold/delay para el look-ahead pedido y resetea el estado */
+    void configure(float ms);
+
+    /** Ganancia requerida por sample del segmento (vectorizable): min(1, ceiling / pico estimado) */
+    void computeRequiredGain(const float* const* channels, int numChannels, int numSamples,
+                             float ceiling, float* requiredGain);
+
+    /** Hold + release + media móvil: ganancia a aplicar por sample (estado serie) */
+    void computeGain(const float* requiredGain, float* gain, int numSamples);
+};
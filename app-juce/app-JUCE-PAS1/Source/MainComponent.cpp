@@ -1,5 +1,6 @@
 #include "MainComponent.h"
 #include <atomic>
+#include <chrono>
 #include <random>
 
 //==============================================================================
@@ -7,7 +8,8 @@ MainComponent::MainComponent()
     : pitchRandomGen(std::random_device{}()), pitchRandomDist(0.0f, 1.0f)
 {
     // Configurar sliders y labels
-    setupSlider(voicesSlider, voicesLabel, "Voices", 4.0, 24.0, 8.0, 1.0); // M3: 4-24 para mayor polyfonía perceptual
+    setupSlider(voicesSlider, voicesLabel, "Voices", 4.0, (double)synthesisEngine.getVoicePoolSize(), 8.0, 1.0); // Hasta el pool pre-allocado; skew para que 4-24 (M3) siga siendo cómodo
+    voicesSlider.setSkewFactorFromMidPoint(24.0);
     setupSlider(metalnessSlider, metalnessLabel, "Metalness", 0.0, 1.0, 0.5); // Dispersión de modos inarmónicos
     setupSlider(brightnessSlider, brightnessLabel, "Brightness", 0.0, 1.0, 0.5); // Tilt espectral (0=oscuro, 1=brillante)
     setupSlider(dampingSlider, dampingLabel, "Damping", 0.0, 1.0, 0.5); // Tiempo de decaimiento (0=corto, 1=largo)
@@ -41,6 +43,47 @@ MainComponent::MainComponent()
     limiterLabel.attachToComponent(&limiterToggle, false);
     addAndMakeVisible(&limiterLabel);
 
+    // Look-ahead true-peak limiter instead of the per-sample clipper (adds ~1.5 ms latency)
+    lookAheadToggle.setButtonText("Look-ahead Limiter");
+    lookAheadToggle.setToggleState(synthesisEngine.isLimiterLookAhead(), juce::dontSendNotification);
+    lookAheadToggle.addListener(this);
+    addAndMakeVisible(&lookAheadToggle);
+
+    // Engine mode: shared resonator bank instead of per-hit voices
+    resonatorBankToggle.setButtonText("Resonator Bank");
+    resonatorBankToggle.setToggleState(synthesisEngine.isResonatorBankMode(), juce::dontSendNotification);
+    resonatorBankToggle.addListener(this);
+    addAndMakeVisible(&resonatorBankToggle);
+
+    // Plate: per-channel allpass decorrelation (full amount) or identical mono on every channel
+    plateDecorrelationToggle.setButtonText("Plate Decorrelation");
+    plateDecorrelationToggle.setToggleState(synthesisEngine.getPlateDecorrelation() > 0.0f, juce::dontSendNotification);
+    plateDecorrelationToggle.addListener(this);
+    addAndMakeVisible(&plateDecorrelationToggle);
+
+    // Voice pool: pre-allocated in prepare, so changing it reopens the audio device
+    for (int pool = VoiceManager::DEFAULT_POOL_SIZE; pool <= VoiceManager::MAX_POOL_SIZE; pool *= 2)
+        voicePoolComboBox.addItem(juce::String(pool), pool);
+    voicePoolComboBox.setSelectedId(synthesisEngine.getVoicePoolSize(), juce::dontSendNotification);
+    voicePoolComboBox.addListener(this);
+    addAndMakeVisible(&voicePoolComboBox);
+    voicePoolLabel.setText("Voice Pool", juce::dontSendNotification);
+    voicePoolLabel.attachToComponent(&voicePoolComboBox, false);
+    voicePoolLabel.setJustificationType(juce::Justification::centredLeft);
+    addAndMakeVisible(&voicePoolLabel);
+
+    // Voice render threads besides the audio thread (created on first use)
+    const int maxRenderThreads = juce::jmax(0, juce::jmin(VoiceManager::MAX_RENDER_WORKERS, juce::SystemStats::getNumCpus() - 1));
+    for (int threads = 0; threads <= maxRenderThreads; threads++)
+        renderThreadsComboBox.addItem(threads == 0 ? juce::String("Off") : juce::String(threads), threads + 1);
+    renderThreadsComboBox.setSelectedId(synthesisEngine.getVoiceRenderThreads() + 1, juce::dontSendNotification);
+    renderThreadsComboBox.addListener(this);
+    addAndMakeVisible(&renderThreadsComboBox);
+    renderThreadsLabel.setText("Render Threads", juce::dontSendNotification);
+    renderThreadsLabel.attachToComponent(&renderThreadsComboBox, false);
+    renderThreadsLabel.setJustificationType(juce::Justification::centredLeft);
+    addAndMakeVisible(&renderThreadsLabel);
+
     // M4 toggles (Density Comp, Center Bias) - visibility in resized when M4
     densityCompToggle.setButtonText("Density Comp");
     densityCompToggle.setToggleState(enableDensityCompensation, juce::dontSendNotification);
@@ -109,6 +152,14 @@ MainComponent::MainComponent()
     clipperHitCountLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(&clipperHitCountLabel);
     
+    dspLoadLabel.setText("DSP: 0.0% (p99 0.0%) | 0 xruns", juce::dontSendNotification);
+    dspLoadLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(&dspLoadLabel);
+    
+    dspStagesLabel.setText("p99 Q 0.0 V 0.0 P 0.0 M 0.0 %", juce::dontSendNotification);
+    dspStagesLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(&dspStagesLabel);
+    
     // OSC Receiver setup
     oscStatusLabel.setText("OSC: Disconnected", juce::dontSendNotification);
     oscStatusLabel.setJustificationType(juce::Justification::centred);
@@ -119,6 +170,10 @@ MainComponent::MainComponent()
     oscMessageCountLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(&oscMessageCountLabel);
     
+    oscSequenceLabel.setText("Net: 0 lost, 0 late", juce::dontSendNotification);
+    oscSequenceLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(&oscSequenceLabel);
+    
     // Initialize OSC receiver
     // Use OSCReceiver::Listener<MessageLoopCallback> pattern for JUCE 8.0.12
     if (oscReceiver.connect(9000))
@@ -135,6 +190,11 @@ MainComponent::MainComponent()
     
     lastOscActivityTimestamp = juce::Time::currentTimeMillis();
     lastOscCountUpdateTime = juce::Time::currentTimeMillis();
+    
+    // Backpressure: /load hacia ISTR (UDP, no bloquea aunque ISTR no esté escuchando)
+    loadSenderConnected = loadSender.connect("127.0.0.1", LOAD_FEEDBACK_PORT);
+    lastLoadSendTime = juce::Time::currentTimeMillis();
+    latencySenderConnected = latencySender.connect("127.0.0.1", LATENCY_PROBE_PORT);
     lastClipUpdateTime = juce::Time::currentTimeMillis();
     
     aggregatorTimer.owner = this;
@@ -170,6 +230,9 @@ MainComponent::~MainComponent()
     // Remove OSC listener before disconnecting
     oscReceiver.removeListener(this);
     oscReceiver.disconnect();
+    loadSender.disconnect();
+    metricsSender.disconnect();
+    latencySender.disconnect();
     
     // This shuts down the audio device and clears the audio source.
     shutdownAudio();
@@ -181,8 +244,11 @@ void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRat
     // This function will be called when the audio device is started, or when
     // its settings (i.e. sample rate, block size, etc) are changed.
 
-    // Preparar el motor de síntesis
-    synthesisEngine.prepare(sampleRate);
+    // Preparar el motor de síntesis (plate dimensionado a los canales de salida activos)
+    int numOutputChannels = 2;
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+        numOutputChannels = device->getActiveOutputChannels().countNumberOfSetBits();
+    synthesisEngine.prepare(sampleRate, numOutputChannels);
     
     // Log para debugging: verificar buffer size
     // Si el buffer es muy pequeño (< 256), puede causar sobrecarga del audio thread
@@ -261,6 +327,15 @@ void MainComponent::resized()
     demoModeToggle.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
     rightColumn.removeFromTop(2); // small gap
     limiterToggle.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
+    lookAheadToggle.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
+    resonatorBankToggle.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
+    plateDecorrelationToggle.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
+    auto voicePoolRow = rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2);
+    voicePoolLabel.setBounds(voicePoolRow.removeFromLeft(labelWidth));
+    voicePoolComboBox.setBounds(voicePoolRow);
+    auto renderThreadsRow = rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2);
+    renderThreadsLabel.setBounds(renderThreadsRow.removeFromLeft(labelWidth));
+    renderThreadsComboBox.setBounds(renderThreadsRow);
     bool m4Mode = enableFusionAggregation && enableM4Character;
     if (m4Mode)
     {
@@ -275,8 +350,11 @@ void MainComponent::resized()
     hitsStatsLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
     m2FusionStatsLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
     clipperHitCountLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
+    dspLoadLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
+    dspStagesLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
     oscStatusLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
     oscMessageCountLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
+    oscSequenceLabel.setBounds(rightColumn.removeFromTop(debugRowHeight).reduced(margin, 2));
     
     // Columna izquierda: sliders (ocupa el resto del ancho)
     auto leftColumn = area.reduced(0, 0);
@@ -358,7 +436,9 @@ void MainComponent::resized()
     const bool showAdvanced = !demoMode_;
     m2FusionStatsLabel.setVisible(showAdvanced);
     clipperHitCountLabel.setVisible(showAdvanced);
+    dspStagesLabel.setVisible(showAdvanced);
     hitsStatsLabel.setVisible(showAdvanced);
+    oscSequenceLabel.setVisible(showAdvanced);
     densityCompToggle.setVisible(m4Mode && showAdvanced);
     centerBiasToggle.setVisible(m4Mode && showAdvanced);
 }
@@ -413,6 +493,18 @@ void MainComponent::buttonClicked (juce::Button* button)
     {
         synthesisEngine.setLimiterEnabled(limiterToggle.getToggleState());
     }
+    else if (button == &lookAheadToggle)
+    {
+        synthesisEngine.setLimiterLookAhead(lookAheadToggle.getToggleState());
+    }
+    else if (button == &resonatorBankToggle)
+    {
+        synthesisEngine.setResonatorBankMode(resonatorBankToggle.getToggleState());
+    }
+    else if (button == &plateDecorrelationToggle)
+    {
+        synthesisEngine.setPlateDecorrelation(plateDecorrelationToggle.getToggleState() ? 1.0f : 0.0f);
+    }
     else if (button == &densityCompToggle)
     {
         enableDensityCompensation = densityCompToggle.getToggleState();
@@ -439,6 +531,23 @@ void MainComponent::comboBoxChanged (juce::ComboBox* comboBox)
         if (id >= 1 && id <= 8)
             applyPreset(id - 1);
     }
+    else if (comboBox == &renderThreadsComboBox)
+    {
+        synthesisEngine.setVoiceRenderThreads(renderThreadsComboBox.getSelectedId() - 1);
+    }
+    else if (comboBox == &voicePoolComboBox)
+    {
+        int pool = voicePoolComboBox.getSelectedId();
+        if (pool == synthesisEngine.getVoicePoolSize())
+            return;
+        synthesisEngine.setVoicePoolSize(pool);
+        voicesSlider.setRange(4.0, (double)synthesisEngine.getVoicePoolSize(), 1.0);
+        voicesSlider.setSkewFactorFromMidPoint(24.0);
+        voicesSlider.setValue(synthesisEngine.getMaxVoices(), juce::dontSendNotification);
+        // El pool se dimensiona en prepare: cerrar y reabrir el dispositivo (releaseResources + prepareToPlay)
+        deviceManager.closeAudioDevice();
+        deviceManager.restartLastAudioDevice();
+    }
 }
 
 //==============================================================================
@@ -460,11 +569,13 @@ void MainComponent::timerCallback()
     int hitsReceived = synthesisEngine.getHitsReceived();
     int hitsTriggered = synthesisEngine.getHitsTriggered();
     int hitsDiscarded = synthesisEngine.getHitsDiscarded();
+    int hitsCoalesced = synthesisEngine.getHitsCoalesced();
     float coverageRatio = synthesisEngine.getHitCoverageRatio();
     
     hitsStatsLabel.setText("Hits: " + juce::String(hitsTriggered) + "/" + 
                           juce::String(hitsReceived) + " (" + 
-                          juce::String(hitsDiscarded) + " discarded)", 
+                          juce::String(hitsDiscarded) + " discarded, " +
+                          juce::String(hitsCoalesced) + " coalesced)", 
                           juce::dontSendNotification);
     
     // Mostrar ratio de cobertura con color según umbral
@@ -493,12 +604,21 @@ void MainComponent::timerCallback()
         oscMessagesPerSecond.store(oscMessageCountAccumulator.load());
         oscMessageCountAccumulator.store(0);
         lastOscCountUpdateTime = currentTime;
+        
+        hitsPerSecond = juce::jmax(0, hitsReceived - lastSecondHitsReceived); // 0 tras un reset del contador
+        lastSecondHitsReceived = hitsReceived;
     }
     
     int messagesPerSec = oscMessagesPerSecond.load();
     oscMessageCountLabel.setText("OSC Messages: " + juce::String(messagesPerSec) + "/s", 
                                 juce::dontSendNotification);
     
+    // Pérdidas de red (/hit seq) frente a descartes del motor: localiza el techo de throughput
+    oscSequenceLabel.setText("Net: " + juce::String(hitsLostNetwork.load(std::memory_order_relaxed)) + " lost (" +
+                             juce::String(framesLostNetwork.load(std::memory_order_relaxed)) + " frames), " +
+                             juce::String(hitsLateDiscarded.load(std::memory_order_relaxed)) + " late",
+                             juce::dontSendNotification);
+    
     // M2 fusion metrics: raw, fused produced/enqueued/dropped, coverage, queue loss
     int rawHits = synthesisEngine.getHitsReceived();
     int produced = fusedProduced.load(std::memory_order_relaxed);
@@ -523,8 +643,17 @@ void MainComponent::timerCallback()
         lastClipUpdateTime = now;
         double blocksPerSec = deltaBlocks / deltaSec;
         clipperHitCountLabel.setText("Clip: " + juce::String(blocksPerSec, 1) + " blocks/s", juce::dontSendNotification);
+        
+        // Carga del audio thread en el mismo intervalo (único lector del monitor)
+        lastLoadSnapshot = synthesisEngine.takeLoadSnapshot();
+        updateLoadLabels();
     }
     
+    if (now - lastLoadSendTime >= LOAD_FEEDBACK_INTERVAL_MS)
+        sendLoadFeedback(now);
+    
+    sendLatencyProbes();
+    
     // Update OSC status color based on recent activity
     juce::int64 timeSinceLastMessage = currentTime - lastOscActivityTimestamp;
     if (timeSinceLastMessage < 2000) // Active if message in last 2 seconds
@@ -537,6 +666,141 @@ void MainComponent::timerCallback()
     }
 }
 
+//==============================================================================
+void MainComponent::sendLoadFeedback(juce::int64 now)
+{
+    lastLoadSendTime = now;
+    
+    // Drop rate del intervalo, cada cola en su unidad: descartes crudos / hits recibidos y descartes
+    // fused / snapshots producidos (un snapshot representa varios hits). Se envía el peor de los dos.
+    int received = synthesisEngine.getHitsReceived();
+    int dropped = synthesisEngine.getHitsDiscarded();
+    int fusedDropped = synthesisEngine.getFusedHitsDiscardedQueue();
+    int fusedProduced = synthesisEngine.getFusedHitsEnqueued() + fusedDropped;
+    int deltaReceived = received - lastLoadHitsReceived;
+    int deltaDropped = dropped - lastLoadHitsDropped;
+    int deltaFusedProduced = fusedProduced - lastLoadFusedProduced;
+    int deltaFusedDropped = fusedDropped - lastLoadFusedDropped;
+    lastLoadHitsReceived = received;
+    lastLoadHitsDropped = dropped;
+    lastLoadFusedProduced = fusedProduced;
+    lastLoadFusedDropped = fusedDropped;
+    float rawDropRate = deltaReceived > 0 ? (float)deltaDropped / (float)deltaReceived : 0.0f;
+    float fusedDropRate = deltaFusedProduced > 0 ? (float)deltaFusedDropped / (float)deltaFusedProduced : 0.0f;
+    float dropRate = juce::jlimit(0.0f, 1.0f, juce::jmax(rawDropRate, fusedDropRate));
+    
+    // Leer siempre para que el pico se resetee por intervalo
+    float queueFill = synthesisEngine.getAndResetPeakQueueFill();
+    
+    if (!loadSenderConnected)
+        return;
+    
+    // /load queueFill(float) voicesActive(int32) maxVoices(int32) cpu(float) dropRate(float)
+    juce::OSCMessage msg("/load");
+    msg.addFloat32(queueFill);
+    msg.addInt32(synthesisEngine.getActiveVoiceCount());
+    msg.addInt32(synthesisEngine.getMaxVoices());
+    msg.addFloat32((float)juce::jlimit(0.0, 1.0, deviceManager.getCpuUsage()));
+    msg.addFloat32(dropRate);
+    loadSender.send(msg);
+}
+
+//==============================================================================
+void MainComponent::updateLoadLabels()
+{
+    const auto& snap = lastLoadSnapshot;
+    const auto& total = snap.stages[AudioLoadMonitor::Total];
+    dspLoadLabel.setText("DSP: " + juce::String(total.meanPercent, 1) + "% (p99 " + juce::String(total.p99Percent, 1) +
+                         "%) | " + juce::String(snap.totalOverruns) + " xruns", juce::dontSendNotification);
+    
+    // Rojo si hubo overruns en el intervalo, naranja si el p99 se acerca al presupuesto
+    if (snap.overruns > 0)
+        dspLoadLabel.setColour(juce::Label::textColourId, juce::Colours::red);
+    else if (total.p99Percent > 70.0f)
+        dspLoadLabel.setColour(juce::Label::textColourId, juce::Colours::orange);
+    else
+        dspLoadLabel.setColour(juce::Label::textColourId, juce::Colours::green);
+    
+    dspStagesLabel.setText("p99 Q " + juce::String(snap.stages[AudioLoadMonitor::Queue].p99Percent, 1) +
+                           " V " + juce::String(snap.stages[AudioLoadMonitor::Voices].p99Percent, 1) +
+                           " P " + juce::String(snap.stages[AudioLoadMonitor::Plate].p99Percent, 1) +
+                           " M " + juce::String(snap.stages[AudioLoadMonitor::Master].p99Percent, 1) + " %",
+                           juce::dontSendNotification);
+}
+
+//==============================================================================
+void MainComponent::sendMetricsReply(const juce::OSCMessage& request)
+{
+    // /metrics [replyPort(int32)]: sin puerto responde al de /load (ISTR)
+    int port = LOAD_FEEDBACK_PORT;
+    if (request.size() == 1 && request[0].isInt32())
+        port = juce::jlimit(1024, 65535, (int)request[0].getInt32());
+    
+    if (port != metricsSenderPort)
+    {
+        metricsSender.disconnect();
+        metricsSenderPort = metricsSender.connect("127.0.0.1", port) ? port : 0;
+    }
+    if (metricsSenderPort == 0)
+        return;
+    
+    // /metrics blocks overruns totalOverruns, luego por etapa (queue, voices, plate, master, total)
+    // mean p99 max como fracción del presupuesto del bloque, del último intervalo de 500 ms
+    const auto& snap = lastLoadSnapshot;
+    juce::OSCMessage msg("/metrics");
+    msg.addInt32(snap.blocks);
+    msg.addInt32(snap.overruns);
+    msg.addInt32(snap.totalOverruns);
+    for (int s = 0; s < AudioLoadMonitor::NUM_STAGES; s++)
+    {
+        msg.addFloat32(snap.stages[s].meanPercent * 0.01f);
+        msg.addFloat32(snap.stages[s].p99Percent * 0.01f);
+        msg.addFloat32(snap.stages[s].maxPercent * 0.01f);
+    }
+    metricsSender.send(msg);
+}
+
+//==============================================================================
+void MainComponent::sendLatencyProbes()
+{
+    SynthesisEngine::LatencyProbe probes[LATENCY_PROBES_PER_DRAIN];
+    
+    // Salida estimada tras el callback: el buffer en cola más la latencia que reporta el dispositivo
+    int deviceLatencySamples = 0;
+    double sampleRate = 0.0;
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+    {
+        deviceLatencySamples = device->getCurrentBufferSizeSamples() + device->getOutputLatencyInSamples();
+        sampleRate = device->getCurrentSampleRate();
+    }
+    
+    for (;;)
+    {
+        // Drenar siempre (aunque no haya destino) para que la cola del motor no se llene
+        int n = synthesisEngine.popLatencyProbes(probes, LATENCY_PROBES_PER_DRAIN);
+        if (latencySenderConnected && sampleRate > 0.0)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                const auto& p = probes[i];
+                // /latency tUs toRenderUs outputUs triggerSample activeVoices dspLoad hitsPerSec flags
+                juce::OSCMessage msg("/latency");
+                msg.addInt32((juce::int32)(juce::uint32)(p.sendNs / 1000));
+                msg.addInt32((juce::int32)((p.callbackNs - p.sendNs) / 1000));
+                msg.addInt32((juce::int32)((double)(p.latencySamples + deviceLatencySamples) * 1.0e6 / sampleRate));
+                msg.addInt32((juce::int32)p.triggerSample);
+                msg.addInt32(p.activeVoices);
+                msg.addFloat32(p.blockLoad);
+                msg.addInt32(hitsPerSecond);
+                msg.addInt32((p.fused ? 1 : 0) | (p.coalesced ? 2 : 0));
+                latencySender.send(msg);
+            }
+        }
+        if (n < LATENCY_PROBES_PER_DRAIN)
+            break;
+    }
+}
+
 //==============================================================================
 void MainComponent::setupSlider(juce::Slider& slider, juce::Label& label, 
                                 const juce::String& name,
@@ -577,6 +841,10 @@ void MainComponent::oscMessageReceived(const juce::OSCMessage& message)
     {
         mapOSCPlateToEvent(message);
     }
+    else if (address == "/metrics")
+    {
+        sendMetricsReply(message);
+    }
     // Silently ignore unknown addresses (no crash, no log spam)
 }
 
@@ -638,8 +906,8 @@ void MainComponent::flushAggregatorWindow()
 //==============================================================================
 void MainComponent::mapOSCHitToEvent(const juce::OSCMessage& message)
 {
-    // Validate message format: /hit id(int32) x(float) y(float) energy(float) surface(int32)
-    if (message.size() != 5)
+    // Validate message format: /hit id(int32) x(float) y(float) energy(float) surface(int32) [seq(int32) count(int32) [t_us(int32)]]
+    if (message.size() != 5 && message.size() != 7 && message.size() != 8)
     {
         return;
     }
@@ -650,6 +918,27 @@ void MainComponent::mapOSCHitToEvent(const juce::OSCMessage& message)
         return;
     }
     
+    // Con seq/count: descartar hits de frames ya superados en vez de dispararlos tarde
+    if (message.size() >= 7)
+    {
+        if (!message[5].isInt32() || !message[6].isInt32() || (message.size() == 8 && !message[7].isInt32()))
+            return;
+        if (!acceptHitSequence(message[5].getInt32(), message[6].getInt32()))
+            return;
+    }
+    
+    // Sonda de latencia: t_us = 32 bits bajos de steady_clock en µs en ISTR; se reconstruye con el
+    // reloj local (mismo steady_clock en la misma máquina) restando la edad módulo 2^32
+    juce::int64 probeSendNs = 0;
+    if (message.size() == 8)
+    {
+        const juce::int64 nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        const juce::uint32 ageUs = (juce::uint32)nowUs - (juce::uint32)message[7].getInt32();
+        if (ageUs <= PROBE_MAX_AGE_US)
+            probeSendNs = (nowUs - (juce::int64)ageUs) * 1000;
+    }
+    
     int id = message[0].getInt32();
     float x = juce::jlimit(0.0f, 1.0f, message[1].getFloat32());
     float y = juce::jlimit(0.0f, 1.0f, message[2].getFloat32());
@@ -659,36 +948,67 @@ void MainComponent::mapOSCHitToEvent(const juce::OSCMessage& message)
     if (enableFusionAggregation)
     {
         synthesisEngine.incrementHitsReceived();
-        hitAggregator.addHit(x, y, energy, surface);
+        hitAggregator.addHit(x, y, energy, surface, probeSendNs);
         (void)id;
         return;
     }
     
-    // Modo sin agregación: mapeo directo como antes
-    float amplitude = std::pow(energy, 1.5f);
-    float brightness = 0.3f + (energy * 0.7f);
-    float damping = 0.2f + ((1.0f - y) * 0.6f);
-    float pitchRange = synthesisEngine.getPitchRange();
-    float centerFreq = 300.0f;
-    float maxVariation = 200.0f;
-    float randomValue = pitchRandomDist(pitchRandomGen);
-    float variation = (randomValue * 2.0f - 1.0f) * pitchRange * maxVariation;
-    float baseFreq = juce::jlimit(100.0f, 800.0f, centerFreq + variation);
-    float metalness = synthesisEngine.getMetalness();
+    // Modo sin agregación: mapeo directo (compartido con el render offline)
+    auto mapping = OSCHitMapping::fromHit(y, energy, synthesisEngine.getPitchRange(), pitchRandomDist(pitchRandomGen));
+    synthesisEngine.triggerVoiceFromOSC(mapping.baseFreq, mapping.amplitude, mapping.damping, mapping.brightness,
+                                        synthesisEngine.getMetalness(), mapping.waveform, synthesisEngine.getSubOscMix(),
+                                        probeSendNs);
+    (void)id;
+}
+
+//==============================================================================
+bool MainComponent::acceptHitSequence(juce::int32 seq, int count)
+{
+    // Diferencia con wrap-around (seq es un contador int32 de ISTR)
+    juce::int32 diff = (juce::int32)((juce::uint32)seq - (juce::uint32)hitSeqCurrent);
     
-    ModalVoice::ExcitationWaveform waveform;
-    if (energy > 0.7f)
-        waveform = ModalVoice::ExcitationWaveform::Square;
-    else if (energy > 0.4f)
-        waveform = ModalVoice::ExcitationWaveform::Saw;
-    else if (energy > 0.2f)
-        waveform = ModalVoice::ExcitationWaveform::Noise;
-    else
-        waveform = ModalVoice::ExcitationWaveform::Sine;
+    if (!hitSeqValid || diff > HIT_SEQ_RESYNC_WINDOW || diff < -HIT_SEQ_RESYNC_WINDOW)
+    {
+        // Primer /hit o ISTR reiniciado: resincronizar sin contar pérdidas
+        hitSeqValid = true;
+        hitSeqCurrent = seq;
+        hitSeqExpected = count;
+        hitSeqReceived = 1;
+        hitSeqPrevious = seq - 1;
+        hitSeqPreviousShortfall = 0;
+        return true;
+    }
     
-    float subOscMix = synthesisEngine.getSubOscMix();
-    synthesisEngine.triggerVoiceFromOSC(baseFreq, amplitude, damping, brightness, metalness, waveform, subOscMix);
-    (void)id;
+    if (diff == 0)
+    {
+        hitSeqReceived++;
+        return true;
+    }
+    
+    if (diff > 0)
+    {
+        // Cerrar frame en curso: lo que faltó cuenta como perdido (salvo que llegue tarde)
+        int shortfall = juce::jmax(0, hitSeqExpected - hitSeqReceived);
+        hitsLostNetwork.fetch_add(shortfall, std::memory_order_relaxed);
+        if (diff > 1)
+            framesLostNetwork.fetch_add(diff - 1, std::memory_order_relaxed);
+        
+        hitSeqPrevious = hitSeqCurrent;
+        hitSeqPreviousShortfall = shortfall;
+        hitSeqCurrent = seq;
+        hitSeqExpected = count;
+        hitSeqReceived = 1;
+        return true;
+    }
+    
+    // diff < 0: frame ya superado. Si es del frame recién cerrado, no estaba perdido sino reordenado.
+    if (seq == hitSeqPrevious && hitSeqPreviousShortfall > 0)
+    {
+        hitSeqPreviousShortfall--;
+        hitsLostNetwork.fetch_sub(1, std::memory_order_relaxed);
+    }
+    hitsLateDiscarded.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
 //==============================================================================
@@ -3,6 +3,7 @@
 #include <JuceHeader.h>
 #include "SynthesisEngine.h"
 #include "HitAggregator.h"
+#include "OSCHitMapping.h"
 #include <random>
 
 class MainComponent;
@@ -76,9 +77,16 @@ private:
     
     juce::ToggleButton limiterToggle;
     juce::Label limiterLabel;
+    juce::ToggleButton lookAheadToggle;     // Limiter look-ahead true-peak en lugar del clipper
+    juce::ToggleButton resonatorBankToggle; // Motor alternativo: banco de resonadores compartido
+    juce::ToggleButton plateDecorrelationToggle; // Allpass por canal en la placa (off = mono en todos)
     juce::ToggleButton densityCompToggle;   // M4: compensación por densidad
     juce::ToggleButton centerBiasToggle;    // M4: center bias espacial
     juce::ToggleButton demoModeToggle;       // M5: demo mode (hide advanced UI)
+    juce::ComboBox voicePoolComboBox;       // Pool de voces pre-allocado (reabre el dispositivo)
+    juce::Label voicePoolLabel;
+    juce::ComboBox renderThreadsComboBox;   // Hilos auxiliares de render de voces (id = hilos + 1)
+    juce::Label renderThreadsLabel;
     juce::ComboBox presetComboBox;          // M5: preset selector
     juce::Label presetLabel;
     juce::TextButton resetPresetButton;     // M5: reset to current / default preset
@@ -93,6 +101,11 @@ private:
     int lastBlocksClippedCount = 0;
     juce::int64 lastClipUpdateTime = 0;
     
+    // Carga del audio thread (AudioLoadMonitor): snapshot cada 500 ms, reutilizado por /metrics
+    juce::Label dspLoadLabel;       // "DSP: media (p99, max) | overruns"
+    juce::Label dspStagesLabel;     // p99 por etapa
+    AudioLoadMonitor::Snapshot lastLoadSnapshot;
+    
     /** Fused snapshots produced by M2 aggregator (closeWindow) since start. */
     std::atomic<int> fusedProduced{0};
     
@@ -106,6 +119,43 @@ private:
     std::atomic<int> oscMessageCountAccumulator{0};
     juce::int64 lastOscCountUpdateTime = 0;
     
+    // Secuencia de /hit (seq de frame + count): detecta pérdidas y reordenamiento UDP
+    static constexpr int HIT_SEQ_RESYNC_WINDOW = 1000; // Saltos mayores = ISTR reiniciado, resincronizar
+    juce::Label oscSequenceLabel;
+    bool hitSeqValid = false;
+    juce::int32 hitSeqCurrent = 0;        // Frame en curso
+    int hitSeqExpected = 0;               // count anunciado por el frame en curso
+    int hitSeqReceived = 0;               // /hit recibidos del frame en curso
+    juce::int32 hitSeqPrevious = 0;       // Último frame cerrado
+    int hitSeqPreviousShortfall = 0;      // Hits que le faltaban al cerrarlo (pueden llegar tarde)
+    std::atomic<int> hitsLostNetwork{0};  // Hits anunciados por count que nunca llegaron
+    std::atomic<int> framesLostNetwork{0}; // Frames completos ausentes (saltos de seq)
+    std::atomic<int> hitsLateDiscarded{0}; // /hit de un frame ya superado: descartados, no se disparan tarde
+    
+    // Feedback /load hacia ISTR (backpressure): carga del synth a 10 Hz
+    static constexpr int LOAD_FEEDBACK_PORT = 9001;
+    static constexpr int LOAD_FEEDBACK_INTERVAL_MS = 100;
+    juce::OSCSender loadSender;
+    bool loadSenderConnected = false;
+    juce::int64 lastLoadSendTime = 0;
+    int lastLoadHitsReceived = 0;
+    int lastLoadHitsDropped = 0;
+    int lastLoadFusedProduced = 0;      // Snapshots fused encolados + descartados
+    int lastLoadFusedDropped = 0;
+    
+    // Respuesta a /metrics [replyPort]: por defecto al puerto de /load
+    juce::OSCSender metricsSender;
+    int metricsSenderPort = 0; // 0 = sin conectar
+    
+    // Sondas de latencia hit → sonido (/hit con t_us de ISTR en modo instrumentación): /latency a CALIB
+    static constexpr int LATENCY_PROBE_PORT = 9200;             // maad-2-calib record (--port por defecto, fan-out de ISTR)
+    static constexpr int LATENCY_PROBES_PER_DRAIN = 64;
+    static constexpr juce::uint32 PROBE_MAX_AGE_US = 10000000;  // Más viejo: reloj no compartido (otra máquina), sin sonda
+    juce::OSCSender latencySender;
+    bool latencySenderConnected = false;
+    int hitsPerSecond = 0;              // /hit recibidos en el último segundo (nivel de carga de cada sonda)
+    int lastSecondHitsReceived = 0;
+    
     /** Si false (default), PAS ignora /plate y PlateSynth no recibe triggers. */
     bool enablePlateSynth = false;
     
@@ -143,6 +193,20 @@ private:
     void mapOSCHitToEvent(const juce::OSCMessage& message);
     void updateOSCState(const juce::OSCMessage& message);
     void mapOSCPlateToEvent(const juce::OSCMessage& message);
+    /** Contabiliza seq/count de un /hit. Devuelve false si pertenece a un frame ya superado (descartar). */
+    bool acceptHitSequence(juce::int32 seq, int count);
+
+    /** Envía /load (queue fill, voces activas, CPU, drop rate) a ISTR; llamado desde timerCallback. */
+    void sendLoadFeedback(juce::int64 now);
+
+    /** Responde a /metrics con el último snapshot de carga del audio thread (127.0.0.1, puerto opcional). */
+    void sendMetricsReply(const juce::OSCMessage& request);
+
+    /** Envía un /latency por sonda publicada por el motor; llamado desde timerCallback. */
+    void sendLatencyProbes();
+
+    /** Actualiza los labels de carga DSP con lastLoadSnapshot */
+    void updateLoadLabels();
 
     /** M5: Apply preset by index (0-based). Updates sliders, toggles, engine and aggregator. */
     void applyPreset(int presetIndex);
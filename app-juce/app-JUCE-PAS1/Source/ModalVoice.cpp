@@ -76,15 +76,16 @@ void ModalVoice::setParameters(float baseFreq, float amplitude, float damping,
 }
 
 //==============================================================================
-void ModalVoice::setGlobalParametersOnly(float metalness, float brightness, float damping)
+void ModalVoice::setGlobalParametersOnly(float metalness, float brightness, float damping, bool rampCoefficients)
 {
-    float prevBrightness = currentBrightness;
-    float prevMetalness = currentMetalness;
     currentDamping = juce::jlimit(0.0f, 1.0f, damping);
     currentBrightness = juce::jlimit(0.0f, 1.0f, brightness);
     currentMetalness = juce::jlimit(0.0f, 1.0f, metalness);
-    if (std::abs(prevBrightness - currentBrightness) > 0.01f || std::abs(prevMetalness - currentMetalness) > 0.01f)
-        updateFilterCoefficients();
+    // Comparar contra los valores del último diseño: un barrido lento en pasos < 0.01 también llega
+    // (damping incluido: fija el Q de los modos)
+    if (std::abs(coeffBrightness - currentBrightness) > 0.01f || std::abs(coeffMetalness - currentMetalness) > 0.01f
+        || std::abs(coeffDamping - currentDamping) > 0.01f)
+        updateFilterCoefficients(rampCoefficients);
     float dampingInverted = 1.0f - currentDamping;
     energyScaledAttackMs = juce::jmap(currentAmplitude, 0.5f, 0.1f, 0.1f, 2.0f);
     float decayTimeMs = juce::jmap(dampingInverted * dampingInverted, 0.0f, 1.0f, 10.0f, 500.0f);
@@ -120,8 +121,8 @@ void ModalVoice::trigger()
     subOsc.setFrequency(currentBaseFreq * 0.5f, currentSampleRate);
     subOsc.reset();
     
-    generateExcitation();
-    isExciting = true;
+    selectExcitation();
+    isExciting = excitationTable != nullptr;
     excitationPosition = 0;
     
     // Iniciar envolvente ADSR desde Attack
@@ -130,69 +131,179 @@ void ModalVoice::trigger()
     envelopeIncrement = attackIncrement;
     
     residualAmplitude = currentAmplitude;
+    silentBlocks = 0;
 }
 
 //==============================================================================
 float ModalVoice::renderNextSample()
 {
-    // RT-SAFE: Check rápido de actividad (evitar procesamiento si está inactiva)
-    if (envelopeStage == EnvelopeStage::Idle && !isExciting)
-        return 0.0f;
-    
-    // Generar excitación si aún está activa - optimizado RT-safe
-    float excitation = 0.0f;
-    if (isExciting && excitationPosition < excitationLength)
+    float sample = 0.0f;
+    renderBlock(&sample, 1);
+    return sample;
+}
+
+//==============================================================================
+void ModalVoice::renderBlock(float* out, int numSamples)
+{
+    int pos = 0;
+    while (pos < numSamples)
     {
-        // Calcular envolvente (optimizado: evitar división cuando sea posible)
-        // Para longitudes típicas (64-128 samples), la división es aceptable
-        float envFactor = 1.0f - ((float)excitationPosition / (float)excitationLength);
-        excitation = excitationBuffer[excitationPosition] * envFactor;
-        excitationPosition++;
-        
-        if (excitationPosition >= excitationLength)
+        // RT-SAFE: Check rápido de actividad (evitar procesamiento si está inactiva)
+        if (envelopeStage == EnvelopeStage::Idle && !isExciting)
         {
-            isExciting = false;
+            juce::FloatVectorOperations::clear(out + pos, numSamples - pos);
+            return;
         }
+        
+        const int len = juce::jmin(RENDER_CHUNK, numSamples - pos);
+        float* dst = out + pos;
+        
+        // Rampas de coeficientes en curso (barridos de parámetros): un paso por segmento
+        modeBank.stepRamp();
+        if (formantEnabled)
+            formantFilter.stepRamp();
+        
+        // Excitación solo mientras dura el burst; después el banco corre sin entrada
+        float excitation[RENDER_CHUNK];
+        const float* input = renderExcitationBlock(excitation, len) ? excitation : nullptr;
+        
+        // RT-SAFE: Procesar los 6 modos como banco SIMD
+        modeBank.process(input, dst, len);
+        
+        applyVoiceStages(dst, len);
+        pos += len;
+    }
+}
+
+//==============================================================================
+bool ModalVoice::renderExcitationBlock(float* excitation, int numSamples)
+{
+    if (!isExciting)
+    {
+        juce::FloatVectorOperations::clear(excitation, numSamples);
+        return false;
     }
     
-    // Actualizar envolvente ADSR primero (antes de procesar)
-    updateEnvelope();
-    
-    // RT-SAFE: Procesar modos (optimizado para 6 modos)
-    float output = modes[0].process(excitation) + modes[1].process(excitation) + 
-                   modes[2].process(excitation) + modes[3].process(excitation) +
-                   modes[4].process(excitation) + modes[5].process(excitation);
-    
+    // Copia directa de la tabla (envolvente del burst ya aplicada), ceros tras el final
+    int remaining = juce::jmin(numSamples, excitationLength - excitationPosition);
+    juce::FloatVectorOperations::copy(excitation, excitationTable + excitationPosition, remaining);
+    if (remaining < numSamples)
+        juce::FloatVectorOperations::clear(excitation + remaining, numSamples - remaining);
+    excitationPosition += remaining;
+    if (excitationPosition >= excitationLength)
+        isExciting = false;
+    return true;
+}
+
+//==============================================================================
+void ModalVoice::applyVoiceStages(float* modesOut, int numSamples)
+{
     // Aplicar filtro formant opcional para más carácter tímbrico
     if (formantEnabled)
     {
-        output = formantFilter.process(output);
+        for (int i = 0; i < numSamples; i++)
+            modesOut[i] = formantFilter.process(modesOut[i]);
     }
     
-    // Aplicar envolvente ADSR
-    float envAmp = envelope * currentAmplitude;
-    output *= envAmp;
+    applyEnvelopeStages(modesOut, numSamples);
+}
+
+//==============================================================================
+void ModalVoice::applyEnvelopeStages(float* voiceOut, int numSamples)
+{
+    // numSamples <= RENDER_CHUNK (envolvente en buffer local)
+    jassert(numSamples <= RENDER_CHUNK);
+    
+    // Aplicar envolvente ADSR (y sub-oscillator si está activo)
+    float envelopeBlock[RENDER_CHUNK];
+    renderEnvelopeBlock(envelopeBlock, numSamples);
     
-    // Agregar sub-oscillator si está activo
     if (currentSubOscMix > 0.0f)
     {
-        float subOscOutput = renderSubOscillator();
-        output += subOscOutput * currentSubOscMix * envAmp;
+        for (int i = 0; i < numSamples; i++)
+        {
+            float envAmp = envelopeBlock[i] * currentAmplitude;
+            voiceOut[i] = voiceOut[i] * envAmp + renderSubOscillator() * currentSubOscMix * envAmp;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; i++)
+            voiceOut[i] *= envelopeBlock[i] * currentAmplitude;
     }
     
-    // Actualizar amplitud residual (para voice stealing) - solo si es significativo
-    // RT-SAFE: Usar multiplicación en lugar de std::abs() cuando sea posible
-    if (envelope > 0.001f)
+    // Tracker de nivel: pico y energía del segmento (sin branches, vectorizable)
+    float peak = blockPeak;
+    float sumSquares = 0.0f;
+    for (int i = 0; i < numSamples; i++)
     {
-        float absOutput = output >= 0.0f ? output : -output;
-        residualAmplitude = absOutput * envelope;
+        peak = std::max(peak, std::abs(voiceOut[i]));
+        sumSquares += voiceOut[i] * voiceOut[i];
     }
+    blockPeak = peak;
+    blockSumSquares += sumSquares;
+    blockSamples += numSamples;
+}
+
+//==============================================================================
+bool ModalVoice::finishBlock(float silenceFloorGain, int silenceHoldBlocks)
+{
+    if (blockSamples > 0)
+        residualAmplitude = std::sqrt(blockSumSquares / (float)blockSamples);
+    
+    // Solo colas: la excitación y el attack pueden empezar por debajo del piso
+    bool inTail = !isExciting && (envelopeStage == EnvelopeStage::Decay || envelopeStage == EnvelopeStage::Release);
+    if (inTail && blockSamples > 0 && blockPeak < silenceFloorGain)
+        silentBlocks++;
     else
+        silentBlocks = 0;
+    
+    blockPeak = 0.0f;
+    blockSumSquares = 0.0f;
+    blockSamples = 0;
+    
+    if (silentBlocks >= silenceHoldBlocks)
+        reset();
+    
+    return isActive();
+}
+
+//==============================================================================
+void ModalVoice::ModeBank::process(const float* input, float* out, int numSamples)
+{
+    // Loops internos de MODE_LANES fijos sin dependencias entre lanes: el compilador los
+    // vectoriza (2x SSE/NEON o 1x AVX). Suma horizontal por pares como en un reduce SIMD.
+    float yn[MODE_LANES];
+    
+    if (input == nullptr && x1 == 0.0f && x2 == 0.0f)
     {
-        residualAmplitude = 0.0f;
+        // Ringing libre: solo la recursión de salida
+        for (int i = 0; i < numSamples; i++)
+        {
+            for (int m = 0; m < MODE_LANES; m++)
+            {
+                yn[m] = -a1[m] * y1[m] - a2[m] * y2[m];
+                y2[m] = y1[m];
+                y1[m] = yn[m];
+            }
+            out[i] = ((yn[0] + yn[4]) + (yn[1] + yn[5])) + ((yn[2] + yn[6]) + (yn[3] + yn[7]));
+        }
+        return;
     }
     
-    return output;
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float x = input != nullptr ? input[i] : 0.0f;
+        for (int m = 0; m < MODE_LANES; m++)
+        {
+            yn[m] = b0[m] * x + b2[m] * x2 - a1[m] * y1[m] - a2[m] * y2[m];
+            y2[m] = y1[m];
+            y1[m] = yn[m];
+        }
+        x2 = x1;
+        x1 = x;
+        out[i] = ((yn[0] + yn[4]) + (yn[1] + yn[5])) + ((yn[2] + yn[6]) + (yn[3] + yn[7]));
+    }
 }
 
 //==============================================================================
@@ -211,10 +322,7 @@ float ModalVoice::getResidualAmplitude() const
 //==============================================================================
 void ModalVoice::reset()
 {
-    for (int i = 0; i < NUM_MODES; i++)
-    {
-        modes[i].reset();
-    }
+    modeBank.reset();
     
     formantFilter.reset();
     
@@ -222,14 +330,19 @@ void ModalVoice::reset()
     
     excitationPosition = 0;
     excitationLength = 0;
+    excitationTable = nullptr;
     isExciting = false;
     envelope = 0.0f;
     envelopeStage = EnvelopeStage::Idle;
     residualAmplitude = 0.0f;
+    blockPeak = 0.0f;
+    blockSumSquares = 0.0f;
+    blockSamples = 0;
+    silentBlocks = 0;
 }
 
 //==============================================================================
-void ModalVoice::updateFilterCoefficients()
+void ModalVoice::updateFilterCoefficients(bool ramp)
 {
     for (int i = 0; i < NUM_MODES; i++)
     {
@@ -237,211 +350,41 @@ void ModalVoice::updateFilterCoefficients()
         float gain = calculateModeGain(i);
         float q = calculateModeQ(i);
         
-        modes[i].setCoefficients(freq, q, gain, currentSampleRate);
+        if (ramp)
+            modeBank.setTargetCoefficients(i, freq, q, gain, currentSampleRate);
+        else
+            modeBank.setCoefficients(i, freq, q, gain, currentSampleRate);
     }
+    modeBank.rampChunks = ramp ? COEFF_RAMP_CHUNKS : 0;
     
     // Actualizar filtro formant: ajustar frecuencia según brightness para más expresividad
     // Brightness alto = formant más alto (más brillante)
     float formantFreqAdjusted = formantFreq * (1.0f + currentBrightness * 0.5f); // 3kHz a 4.5kHz
     float formantGainAdjusted = formantGain * (0.8f + currentBrightness * 0.4f); // 1.04 a 1.56
-    formantFilter.setCoefficients(formantFreqAdjusted, formantQ, formantGainAdjusted, currentSampleRate);
-}
-
-//==============================================================================
-void ModalVoice::generateExcitation()
-{
-    // Duración variable: 4-8ms (más corta = más aguda, más metálica)
-    float durationMs = 4.0f + random.nextFloat() * 4.0f; // 4-8ms variable
-    excitationLength = (int)(durationMs * 0.001f * currentSampleRate);
-    excitationLength = juce::jlimit(1, 128, excitationLength);
-    
-    // Seleccionar método de generación según forma de onda
-    switch (currentWaveform)
-    {
-        case ExcitationWaveform::Noise:
-            generateNoiseExcitation();
-            break;
-        case ExcitationWaveform::Sine:
-            generateSineExcitation();
-            break;
-        case ExcitationWaveform::Square:
-            generateSquareExcitation();
-            break;
-        case ExcitationWaveform::Saw:
-            generateSawExcitation();
-            break;
-        case ExcitationWaveform::Triangle:
-            generateTriangleExcitation();
-            break;
-        case ExcitationWaveform::Click:
-            generateClickExcitation();
-            break;
-        case ExcitationWaveform::Pulse:
-            generatePulseExcitation();
-            break;
-    }
-}
-
-//==============================================================================
-void ModalVoice::generateNoiseExcitation()
-{
-    // Generar excitación con más contenido de alta frecuencia para timbre metálico "coin cascade"
-    // Aumentar presencia de ruido filtrado en el ataque para reforzar textura granular
-    const float scale = 2.5f; // Aumentado para más presencia
-    const float offset = -1.25f;
-    float prevSample = 0.0f;
-    float prevDiff = 0.0f;
-    
-    for (int i = 0; i < excitationLength; i++)
-    {
-        // Generar ruido blanco
-        float noise = random.nextFloat() * scale + offset; // -1.25 a 1.25
-        
-        // Aplicar diferenciación doble (high-pass más agresivo) para más contenido de alta frecuencia
-        // Esto crea un click más agudo y metálico, característico de objetos metálicos pequeños
-        float diff = noise - prevSample;
-        float diff2 = diff - prevDiff; // Segunda derivada para más agudeza
-        prevSample = noise;
-        prevDiff = diff;
-        
-        // Envolvente más agresiva en el ataque (menos suavidad = más percusivo)
-        float env = 1.0f - ((float)i / (float)excitationLength);
-        // Envolvente menos suave para mantener más energía en el ataque
-        env = std::sqrt(env); // Raíz cuadrada en lugar de cuadrática = menos suave
-        
-        // Mezclar señal diferenciada simple y doble para textura más rica
-        float mixed = diff * 0.7f + diff2 * 0.3f;
-        
-        excitationBuffer[i] = mixed * env * 2.0f; // Amplificado para más presencia
-    }
-}
-
-//==============================================================================
-void ModalVoice::generateSineExcitation()
-{
-    // Sinusoidal suave: ciclo completo de seno con envolvente
-    const float twoPi = 2.0f * juce::MathConstants<float>::pi;
-    const float cycles = 1.0f; // Un ciclo completo
-    
-    for (int i = 0; i < excitationLength; i++)
-    {
-        float phase = (float)i / (float)excitationLength * cycles * twoPi;
-        float sine = std::sin(phase);
-        
-        // Envolvente exponencial para suavizar
-        float env = 1.0f - ((float)i / (float)excitationLength);
-        env = env * env;
-        
-        excitationBuffer[i] = sine * env * 0.8f;
-    }
-}
-
-//==============================================================================
-void ModalVoice::generateSquareExcitation()
-{
-    // Cuadrada agresiva: onda cuadrada con envolvente
-    const float cycles = 2.0f; // Varios ciclos para más agresividad
-    
-    for (int i = 0; i < excitationLength; i++)
-    {
-        float phase = (float)i / (float)excitationLength * cycles;
-        float square = (std::fmod(phase, 1.0f) < 0.5f) ? 1.0f : -1.0f;
-        
-        // Envolvente exponencial
-        float env = 1.0f - ((float)i / (float)excitationLength);
-        env = env * env;
-        
-        excitationBuffer[i] = square * env * 0.7f;
-    }
-}
-
-//==============================================================================
-void ModalVoice::generateSawExcitation()
-{
-    // Diente de sierra brillante: rampa descendente con envolvente
-    const float cycles = 2.0f;
-    
-    for (int i = 0; i < excitationLength; i++)
-    {
-        float phase = std::fmod((float)i / (float)excitationLength * cycles, 1.0f);
-        float saw = 1.0f - (phase * 2.0f); // De 1 a -1
-        
-        // Envolvente exponencial
-        float env = 1.0f - ((float)i / (float)excitationLength);
-        env = env * env;
-        
-        excitationBuffer[i] = saw * env * 0.6f;
-    }
-}
-
-//==============================================================================
-void ModalVoice::generateTriangleExcitation()
-{
-    // Triangular suave: onda triangular con envolvente
-    const float cycles = 2.0f;
-    
-    for (int i = 0; i < excitationLength; i++)
-    {
-        float phase = std::fmod((float)i / (float)excitationLength * cycles, 1.0f);
-        float triangle;
-        if (phase < 0.5f)
-            triangle = 1.0f - (phase * 4.0f); // De 1 a -1 en primera mitad
-        else
-            triangle = -1.0f + ((phase - 0.5f) * 4.0f); // De -1 a 1 en segunda mitad
-        
-        // Envolvente exponencial
-        float env = 1.0f - ((float)i / (float)excitationLength);
-        env = env * env;
-        
-        excitationBuffer[i] = triangle * env * 0.7f;
-    }
-}
-
-//==============================================================================
-void ModalVoice::generateClickExcitation()
-{
-    // Impulso delta percusivo: impulso muy corto y agudo
-    // Solo los primeros samples tienen señal, el resto es cero
-    int clickLength = juce::jmin(4, excitationLength); // Muy corto: 4 samples máximo
+    if (ramp)
+        formantFilter.setTargetCoefficients(formantFreqAdjusted, formantQ, formantGainAdjusted, currentSampleRate);
+    else
+        formantFilter.setCoefficients(formantFreqAdjusted, formantQ, formantGainAdjusted, currentSampleRate);
     
-    for (int i = 0; i < excitationLength; i++)
-    {
-        if (i < clickLength)
-        {
-            // Impulso con envolvente muy rápida
-            float env = 1.0f - ((float)i / (float)clickLength);
-            excitationBuffer[i] = env * 2.0f; // Alto para ser percusivo
-        }
-        else
-        {
-            excitationBuffer[i] = 0.0f;
-        }
-    }
+    coeffDamping = currentDamping;
+    coeffBrightness = currentBrightness;
+    coeffMetalness = currentMetalness;
 }
 
 //==============================================================================
-void ModalVoice::generatePulseExcitation()
+void ModalVoice::selectExcitation()
 {
-    // Pulso estrecho muy agudo: pulso muy corto tipo "tick"
-    int pulseWidth = juce::jmin(2, excitationLength / 4); // Muy estrecho
-    
-    for (int i = 0; i < excitationLength; i++)
-    {
-        if (i < pulseWidth)
-        {
-            // Pulso positivo corto
-            excitationBuffer[i] = 1.5f;
-        }
-        else if (i < pulseWidth * 2)
-        {
-            // Pulso negativo corto (para balance)
-            excitationBuffer[i] = -1.5f;
-        }
-        else
-        {
-            excitationBuffer[i] = 0.0f;
-        }
-    }
+    excitationTable = nullptr;
+    excitationLength = 0;
+    if (excitationTables == nullptr)
+        return;
+    
+    // Duración 4-8ms y realización de ruido al azar: solo índices, las tablas están precalculadas
+    int lengthVariant = random.nextInt(ExcitationTables::NUM_LENGTH_VARIANTS);
+    int noiseVariant = (currentWaveform == ExcitationWaveform::Noise)
+        ? random.nextInt(ExcitationTables::NUM_NOISE_VARIANTS) : 0;
+    excitationTable = excitationTables->getTable(static_cast<int>(currentWaveform), lengthVariant, noiseVariant);
+    excitationLength = excitationTables->getLength(lengthVariant);
 }
 
 //==============================================================================
@@ -537,44 +480,67 @@ void ModalVoice::updateADSRSamples()
 }
 
 //==============================================================================
-void ModalVoice::updateEnvelope()
+void ModalVoice::renderEnvelopeBlock(float* env, int numSamples)
 {
-    switch (envelopeStage)
+    // El switch se evalúa una vez por etapa dentro del segmento, no por sample
+    int i = 0;
+    while (i < numSamples)
     {
-        case EnvelopeStage::Attack:
-            envelope += attackIncrement;
-            if (envelope >= 1.0f)
-            {
-                envelope = 1.0f;
-                envelopeStage = EnvelopeStage::Decay;
-                envelopeIncrement = -decayIncrement;
-            }
-            break;
-            
-        case EnvelopeStage::Decay:
-            envelope += envelopeIncrement; // Negativo (decay)
-            if (envelope <= sustainLevel)
-            {
-                envelope = 0.0f;
-                envelopeStage = EnvelopeStage::Idle;
-            }
-            break;
-
-        case EnvelopeStage::Sustain:
-            // Unused: percussive envelope goes Decay -> Idle only
-            break;
-            
-        case EnvelopeStage::Release:
-            envelope -= releaseIncrement;
-            if (envelope <= 0.0f)
-            {
-                envelope = 0.0f;
-                envelopeStage = EnvelopeStage::Idle;
-            }
-            break;
-            
-        case EnvelopeStage::Idle:
-            // Ya está inactivo
-            break;
+        switch (envelopeStage)
+        {
+            case EnvelopeStage::Attack:
+                while (i < numSamples)
+                {
+                    envelope += attackIncrement;
+                    if (envelope >= 1.0f)
+                    {
+                        envelope = 1.0f;
+                        envelopeStage = EnvelopeStage::Decay;
+                        envelopeIncrement = -decayIncrement;
+                        env[i++] = envelope;
+                        break;
+                    }
+                    env[i++] = envelope;
+                }
+                break;
+                
+            case EnvelopeStage::Decay:
+                while (i < numSamples)
+                {
+                    envelope += envelopeIncrement; // Negativo (decay)
+                    if (envelope <= sustainLevel)
+                    {
+                        envelope = 0.0f;
+                        envelopeStage = EnvelopeStage::Idle;
+                        env[i++] = envelope;
+                        break;
+                    }
+                    env[i++] = envelope;
+                }
+                break;
+                
+            case EnvelopeStage::Release:
+                while (i < numSamples)
+                {
+                    envelope -= releaseIncrement;
+                    if (envelope <= 0.0f)
+                    {
+                        envelope = 0.0f;
+                        envelopeStage = EnvelopeStage::Idle;
+                        env[i++] = envelope;
+                        break;
+                    }
+                    env[i++] = envelope;
+                }
+                break;
+                
+            case EnvelopeStage::Sustain:
+                // Unused: percussive envelope goes Decay -> Idle only
+            case EnvelopeStage::Idle:
+                // Ya está inactivo (o sostenido): valor constante el resto del segmento
+                while (i < numSamples)
+                    env[i++] = envelope;
+                break;
+        }
     }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BiquadTables.h"
+#include "ExcitationTables.h"
 
 //==============================================================================
 /**
@@ -33,14 +35,20 @@ public:
     /** Prepara la voz con el sample rate */
     void prepare(double sampleRate);
 
+    /** Banco de excitaciones compartido (propiedad del VoiceManager, preparado antes que la voz).
+        Sin banco la voz no se excita. */
+    void setExcitationTables(const ExcitationTables* tables) { excitationTables = tables; }
+
     /** Configura los parámetros de la voz */
     void setParameters(float baseFreq, float amplitude, float damping,
                        float brightness, float metalness,
                        ExcitationWaveform waveform = ExcitationWaveform::Noise,
                        float subOscMix = 0.0f);
 
-    /** Actualiza solo parámetros globales (metalness, brightness, damping). No modifica waveform, subOscMix, baseFreq ni amplitude. RT-safe. */
-    void setGlobalParametersOnly(float metalness, float brightness, float damping);
+    /** Actualiza solo parámetros globales (metalness, brightness, damping). No modifica waveform, subOscMix, baseFreq ni amplitude. RT-safe.
+     *  rampCoefficients: los filtros van a los nuevos coeficientes por rampa lineal (COEFF_RAMP_CHUNKS
+     *  segmentos) en lugar de saltar (sin zipper en barridos sobre voces sonando). */
+    void setGlobalParametersOnly(float metalness, float brightness, float damping, bool rampCoefficients = false);
 
     /** Configura parámetros ADSR (Attack, Decay, Sustain, Release) */
     void setADSR(float attackMs, float decayMs, float sustainLevel, float releaseMs);
@@ -48,15 +56,25 @@ public:
     /** Trigger la voz (inicia la excitación) */
     void trigger();
 
-    /** Renderiza el siguiente sample */
+    /** Renderiza el siguiente sample (equivale a renderBlock de 1 sample) */
     float renderNextSample();
 
+    /** Renderiza numSamples en out (sobrescribe). Banco de modos SIMD, envolvente y excitación
+        aplicadas por segmento. RT-safe: sin allocations, buffers locales de RENDER_CHUNK. */
+    void renderBlock(float* out, int numSamples);
+
     /** Verifica si la voz está activa (aún resonando) */
     bool isActive() const;
 
-    /** Obtiene la amplitud residual actual (para voice stealing) */
+    /** Obtiene la amplitud residual actual (RMS del último bloque; para voice stealing) */
     float getResidualAmplitude() const;
 
+    /** Cierra el bloque del tracker de nivel (pico/RMS acumulados por applyEnvelopeStages).
+     *  Actualiza la amplitud residual y, si la cola (sin excitación ni attack) queda con pico
+     *  bajo silenceFloorGain durante silenceHoldBlocks bloques seguidos, termina la voz (reset
+     *  de envolvente y estado de filtros). Devuelve isActive(). Llamar una vez por bloque. */
+    bool finishBlock(float silenceFloorGain, int silenceHoldBlocks);
+
     /** Obtiene la frecuencia base actual */
     float getCurrentBaseFreq() const { return currentBaseFreq; }
 
@@ -66,63 +84,52 @@ public:
     /** Resetea la voz completamente */
     void reset();
 
-private:
     //==============================================================================
     static constexpr int NUM_MODES = 6; // Número de modos resonantes (aumentado para timbre metálico más rico)
+    static constexpr int MODE_LANES = 8;    // 6 modos + 2 lanes de relleno (coef 0): 2x SSE/NEON o 1x AVX
+    static constexpr int RENDER_CHUNK = 64; // Segmento de renderBlock (buffers locales en stack)
+    static constexpr int COEFF_RAMP_CHUNKS = 16; // Rampa de coeficientes en barridos: 16 x 64 samples (~21 ms a 48 kHz)
     
-    // Factores inarmónicos para cada modo (valores optimizados para timbre metálico tipo "coin cascade")
-    // Basados en ratios típicos de barras/placas metálicas delgadas (no formantes tipo madera)
-    static constexpr float INHARMONIC_FACTORS[NUM_MODES] = {
-        1.0f,      // Modo 0: fundamental
-        2.76f,     // Modo 1: segundo modo inarmónico (típico de barra delgada)
-        5.40f,     // Modo 2: tercer modo inarmónico
-        8.93f,     // Modo 3: cuarto modo inarmónico
-        13.34f,    // Modo 4: quinto modo inarmónico
-        18.65f     // Modo 5: sexto modo inarmónico
-    };
-    
-    // Presets modales para diferentes caracteres metálicos (seleccionables por parámetro)
-    enum class ModalPreset
-    {
-        ThinBar,      // Barra delgada (más brillante, modos altos más presentes)
-        ThickPlate,   // Placa gruesa (más oscuro, fundamental más fuerte)
-        Coin          // Moneda (balance medio, timbre "cascade" característico)
-    };
-
-    // Ganancias relativas por modo (para brightness)
-    static constexpr float MODE_GAINS[NUM_MODES] = {
-        1.0f,      // Modo 0: fundamental más fuerte
-        0.8f,      // Modo 1: segundo modo
-        0.9f,      // Modo 2: tercer modo (medio-alto, más brillante)
-        0.7f,      // Modo 3: cuarto modo (alto)
-        0.6f,      // Modo 4: quinto modo
-        0.5f       // Modo 5: sexto modo
-    };
-
-    //==============================================================================
-    struct ResonantFilter
+    /** Banco de biquads bandpass resonantes en layout SoA: los modos avanzan juntos en lanes SIMD.
+        Todos los modos reciben la misma excitación y b1 = 0, así que la historia de entrada
+        (x1, x2) es escalar compartida; solo y1/y2 son por lane. */
+    struct alignas(32) ModeBank
     {
-        // Coeficientes del filtro biquad (bandpass resonante)
-        float b0, b1, b2, a1, a2;
+        // Coeficientes por modo (b1 = 0 en bandpass, omitido)
+        float b0[MODE_LANES], b2[MODE_LANES], a1[MODE_LANES], a2[MODE_LANES];
         
-        // Estados del filtro (delay line)
-        float x1, x2, y1, y2;
+        // Estados: salida por modo, entrada compartida
+        float y1[MODE_LANES], y2[MODE_LANES];
+        float x1, x2;
+        
+        // Rampa lineal hacia nuevos coeficientes: delta por segmento de RENDER_CHUNK.
+        // Interpolar a1/a2 entre dos diseños estables es estable (triángulo de estabilidad convexo).
+        float db0[MODE_LANES], db2[MODE_LANES], da1[MODE_LANES], da2[MODE_LANES];
+        int rampChunks = 0;
+        
+        ModeBank()
+        {
+            for (int m = 0; m < MODE_LANES; m++)
+                b0[m] = b2[m] = a1[m] = a2[m] = db0[m] = db2[m] = da1[m] = da2[m] = 0.0f;
+            reset();
+        }
         
         void reset()
         {
-            x1 = x2 = y1 = y2 = 0.0f;
+            for (int m = 0; m < MODE_LANES; m++)
+                y1[m] = y2[m] = 0.0f;
+            x1 = x2 = 0.0f;
         }
         
-        void setCoefficients(float freq, float q, float gain, double sampleRate)
+        static void design(float freq, float q, float gain, double sampleRate,
+                           float& b0Out, float& b2Out, float& a1Out, float& a2Out)
         {
-            // Diseño de filtro bandpass resonante usando transformación bilineal
-            float w = 2.0f * juce::MathConstants<float>::pi * freq / (float)sampleRate;
-            float cosw = std::cos(w);
-            float sinw = std::sin(w);
+            // Diseño de filtro bandpass resonante usando transformación bilineal (sin/cos por tabla)
+            float sinw, cosw;
+            BiquadTables::sinCos(BiquadTables::omega(freq, sampleRate), sinw, cosw);
             float alpha = sinw / (2.0f * q);
             
             float b0_band = sinw / 2.0f;
-            float b1_band = 0.0f;
             float b2_band = -sinw / 2.0f;
             float a0_band = 1.0f + alpha;
             float a1_band = -2.0f * cosw;
@@ -130,11 +137,114 @@ private:
             
             // Normalizar y aplicar ganancia
             float norm = 1.0f / a0_band;
-            b0 = b0_band * norm * gain;
-            b1 = b1_band * norm * gain;
-            b2 = b2_band * norm * gain;
-            a1 = a1_band * norm;
-            a2 = a2_band * norm;
+            b0Out = b0_band * norm * gain;
+            b2Out = b2_band * norm * gain;
+            a1Out = a1_band * norm;
+            a2Out = a2_band * norm;
+        }
+        
+        /** Coeficientes inmediatos (trigger); cancela una rampa en curso del modo */
+        void setCoefficients(int mode, float freq, float q, float gain, double sampleRate)
+        {
+            design(freq, q, gain, sampleRate, b0[mode], b2[mode], a1[mode], a2[mode]);
+            db0[mode] = db2[mode] = da1[mode] = da2[mode] = 0.0f;
+        }
+        
+        /** Coeficientes destino: el modo llega a ellos en COEFF_RAMP_CHUNKS pasos de stepRamp */
+        void setTargetCoefficients(int mode, float freq, float q, float gain, double sampleRate)
+        {
+            float tb0, tb2, ta1, ta2;
+            design(freq, q, gain, sampleRate, tb0, tb2, ta1, ta2);
+            const float inv = 1.0f / (float)COEFF_RAMP_CHUNKS;
+            db0[mode] = (tb0 - b0[mode]) * inv;
+            db2[mode] = (tb2 - b2[mode]) * inv;
+            da1[mode] = (ta1 - a1[mode]) * inv;
+            da2[mode] = (ta2 - a2[mode]) * inv;
+        }
+        
+        /** Un paso de rampa (al inicio de cada segmento de RENDER_CHUNK) */
+        void stepRamp()
+        {
+            if (rampChunks <= 0)
+                return;
+            for (int m = 0; m < MODE_LANES; m++)
+            {
+                b0[m] += db0[m];
+                b2[m] += db2[m];
+                a1[m] += da1[m];
+                a2[m] += da2[m];
+            }
+            rampChunks--;
+        }
+        
+        /** out[i] = suma de los modos. input == nullptr: sin excitación (solo ringing). */
+        void process(const float* input, float* out, int numSamples);
+    };
+
+    /** Filtro formant (peaking) por voz */
+    struct FormantFilter
+    {
+        float b0, b1, b2, a1, a2;
+        float x1, x2, y1, y2;
+        
+        // Rampa de coeficientes (como ModeBank)
+        float db0 = 0.0f, db1 = 0.0f, db2 = 0.0f, da1 = 0.0f, da2 = 0.0f;
+        int rampChunks = 0;
+        
+        void reset()
+        {
+            x1 = x2 = y1 = y2 = 0.0f;
+        }
+        
+        static void design(float freq, float q, float gain, double sampleRate,
+                           float& b0Out, float& b1Out, float& b2Out, float& a1Out, float& a2Out)
+        {
+            // Peaking filter (EQ boost/cut) - implementación simplificada y RT-safe (sin/cos por tabla)
+            float sinw, cosw;
+            BiquadTables::sinCos(BiquadTables::omega(freq, sampleRate), sinw, cosw);
+            float A = std::sqrt(gain); // Linear gain
+            float alpha = sinw / (2.0f * q);
+            
+            float b0_peak = 1.0f + alpha * A;
+            float b1_peak = -2.0f * cosw;
+            float b2_peak = 1.0f - alpha * A;
+            float a0_peak = 1.0f + alpha / A;
+            float a1_peak = -2.0f * cosw;
+            float a2_peak = 1.0f - alpha / A;
+            
+            float norm = 1.0f / a0_peak;
+            b0Out = b0_peak * norm;
+            b1Out = b1_peak * norm;
+            b2Out = b2_peak * norm;
+            a1Out = a1_peak * norm;
+            a2Out = a2_peak * norm;
+        }
+        
+        void setCoefficients(float freq, float q, float gain, double sampleRate)
+        {
+            design(freq, q, gain, sampleRate, b0, b1, b2, a1, a2);
+            rampChunks = 0;
+        }
+        
+        void setTargetCoefficients(float freq, float q, float gain, double sampleRate)
+        {
+            float tb0, tb1, tb2, ta1, ta2;
+            design(freq, q, gain, sampleRate, tb0, tb1, tb2, ta1, ta2);
+            const float inv = 1.0f / (float)COEFF_RAMP_CHUNKS;
+            db0 = (tb0 - b0) * inv;
+            db1 = (tb1 - b1) * inv;
+            db2 = (tb2 - b2) * inv;
+            da1 = (ta1 - a1) * inv;
+            da2 = (ta2 - a2) * inv;
+            rampChunks = COEFF_RAMP_CHUNKS;
+        }
+        
+        void stepRamp()
+        {
+            if (rampChunks <= 0)
+                return;
+            b0 += db0; b1 += db1; b2 += db2; a1 += da1; a2 += da2;
+            rampChunks--;
         }
         
         float process(float input)
@@ -148,6 +258,56 @@ private:
         }
     };
 
+    //==============================================================================
+    /** Etapas de renderBlock, expuestas para el render voices-across-lanes de VoiceManager:
+        excitación → banco de modos (avanzable externamente vía getModeBank) → formant/ADSR/sub-osc. */
+    
+    /** Llena numSamples de excitación (ceros si no está excitando). Devuelve true si hubo excitación. */
+    bool renderExcitationBlock(float* excitation, int numSamples);
+
+    /** Aplica formant, envolvente, sub-oscillator y amplitud residual sobre la salida del banco de modos. */
+    void applyVoiceStages(float* modesOut, int numSamples);
+
+    /** Como applyVoiceStages pero sin formant (cuando el formant se procesa externamente en lanes). */
+    void applyEnvelopeStages(float* voiceOut, int numSamples);
+
+    ModeBank& getModeBank() { return modeBank; }
+
+    /** Filtro formant de la voz, o nullptr si está deshabilitado */
+    FormantFilter* getFormantFilter() { return formantEnabled ? &formantFilter : nullptr; }
+
+private:
+    //==============================================================================
+    // Factores inarmónicos para cada modo (valores optimizados para timbre metálico tipo "coin cascade")
+    // Basados en ratios típicos de barras/placas metálicas delgadas (no formantes tipo madera)
+    static constexpr float INHARMONIC_FACTORS[NUM_MODES] = {
+        1.0f,      // Modo 0: fundamental
+        2.76f,     // Modo 1: segundo modo inarmónico (típico de barra delgada)
+        5.40f,     // Modo 2: tercer modo inarmónico
+        8.93f,     // Modo 3: cuarto modo inarmónico
+        13.34f,    // Modo 4: quinto modo inarmónico
+        18.65f     // Modo 5: sexto modo inarmónico
+    };
+    
+    // Presets modales para diferentes caracteres metálicos (seleccionables por parámetro)
+    enum class ModalPreset
+    {
+        ThinBar,      // Barra delgada (más brillante, modos altos más presentes)
+        ThickPlate,   // Placa gruesa (más oscuro, fundamental más fuerte)
+        Coin          // Moneda (balance medio, timbre "cascade" característico)
+    };
+
+    // Ganancias relativas por modo (para brightness)
+    static constexpr float MODE_GAINS[NUM_MODES] = {
+        1.0f,      // Modo 0: fundamental más fuerte
+        0.8f,      // Modo 1: segundo modo
+        0.9f,      // Modo 2: tercer modo (medio-alto, más brillante)
+        0.7f,      // Modo 3: cuarto modo (alto)
+        0.6f,      // Modo 4: quinto modo
+        0.5f       // Modo 5: sexto modo
+    };
+
+
     //==============================================================================
     struct SubOscillator
     {
@@ -209,59 +369,19 @@ private:
     float currentBrightness = 0.5f;
     float currentMetalness = 0.5f;
     
+    // Parámetros con los que se diseñaron los coeficientes actuales (evita deriva de cambios pequeños acumulados)
+    float coeffDamping = -1.0f;
+    float coeffBrightness = -1.0f;
+    float coeffMetalness = -1.0f;
+    
     // Variación aleatoria sutil en frecuencias (para timbre más rico y menos repetitivo)
     float frequencyVariation[NUM_MODES];
     juce::Random freqRandom;
     
     // Filtros resonantes para cada modo
-    ResonantFilter modes[NUM_MODES];
+    ModeBank modeBank;
     
     // Filtro formant opcional para más carácter tímbrico (peaking filter)
-    struct FormantFilter
-    {
-        float b0, b1, b2, a1, a2;
-        float x1, x2, y1, y2;
-        
-        void reset()
-        {
-            x1 = x2 = y1 = y2 = 0.0f;
-        }
-        
-        void setCoefficients(float freq, float q, float gain, double sampleRate)
-        {
-            // Peaking filter (EQ boost/cut) - implementación simplificada y RT-safe
-            float w = 2.0f * juce::MathConstants<float>::pi * freq / (float)sampleRate;
-            float cosw = std::cos(w);
-            float sinw = std::sin(w);
-            float A = std::sqrt(gain); // Linear gain
-            float alpha = sinw / (2.0f * q);
-            
-            float b0_peak = 1.0f + alpha * A;
-            float b1_peak = -2.0f * cosw;
-            float b2_peak = 1.0f - alpha * A;
-            float a0_peak = 1.0f + alpha / A;
-            float a1_peak = -2.0f * cosw;
-            float a2_peak = 1.0f - alpha / A;
-            
-            float norm = 1.0f / a0_peak;
-            b0 = b0_peak * norm;
-            b1 = b1_peak * norm;
-            b2 = b2_peak * norm;
-            a1 = a1_peak * norm;
-            a2 = a2_peak * norm;
-        }
-        
-        float process(float input)
-        {
-            float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
-            x2 = x1;
-            x1 = input;
-            y2 = y1;
-            y1 = output;
-            return output;
-        }
-    };
-    
     FormantFilter formantFilter;
     bool formantEnabled = true; // Habilitado por defecto para timbre metálico
     float formantFreq = 3000.0f; // Frecuencia formant típica para metales (3kHz)
@@ -270,7 +390,8 @@ private:
     
     // Excitación: buffer de ruido con envolvente
     juce::Random random;
-    float excitationBuffer[128]; // Máximo 5ms a 48kHz (reducido para mejor rendimiento)
+    const ExcitationTables* excitationTables = nullptr;
+    const float* excitationTable = nullptr; // Tabla elegida en trigger (envolvente ya aplicada)
     int excitationLength = 0;
     int excitationPosition = 0;
     bool isExciting = false;
@@ -311,20 +432,21 @@ private:
     // Amplitud residual para voice stealing
     float residualAmplitude = 0.0f;
     
+    // Tracker de nivel por bloque (fin temprano de colas inaudibles)
+    float blockPeak = 0.0f;
+    float blockSumSquares = 0.0f;
+    int blockSamples = 0;
+    int silentBlocks = 0;   // Bloques seguidos de cola bajo el piso de silencio
+    
     // Sub-oscillator
     SubOscillator subOsc;
     float currentSubOscMix = 0.0f;
     
     //==============================================================================
-    void updateFilterCoefficients();
-    void generateExcitation();
-    void generateNoiseExcitation();
-    void generateSineExcitation();
-    void generateSquareExcitation();
-    void generateSawExcitation();
-    void generateTriangleExcitation();
-    void generateClickExcitation();
-    void generatePulseExcitation();
+    /** Rediseña modos y formant con los parámetros actuales. ramp = true: rampa desde los coeficientes actuales. */
+    void updateFilterCoefficients(bool ramp = false);
+    /** Elige tabla de excitación (forma de onda, duración y realización de ruido). O(1), RT-safe. */
+    void selectExcitation();
     float renderSubOscillator();
     float calculateModeFrequency(int modeIndex) const;
     float calculateModeGain(int modeIndex) const;
@@ -332,5 +454,6 @@ private:
     
     // Métodos ADSR
     void updateADSRSamples();
-    void updateEnvelope();
+    /** Avanza la envolvente numSamples y escribe su valor por sample (switch por etapa, no por sample) */
+    void renderEnvelopeBlock(float* env, int numSamples);
 };
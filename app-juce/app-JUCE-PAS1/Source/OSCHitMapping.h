@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ModalVoice.h"
+
+//==============================================================================
+/**
+    Mapeo /hit → parámetros de voz del modo sin agregación.
+
+    Compartido por MainComponent (OSC en vivo) y el render offline, para que una sesión grabada
+    suene igual reproducida que en directo.
+*/
+struct OSCHitMapping
+{
+    float baseFreq;
+    float amplitude;
+    float damping;
+    float brightness;
+    ModalVoice::ExcitationWaveform waveform;
+
+    /** y/energy ya limitados a 0..1; randomValue uniforme en [0, 1) para la variación de pitch */
+    static OSCHitMapping fromHit(float y, float energy, float pitchRange, float randomValue)
+    {
+        OSCHitMapping mapping;
+        mapping.amplitude = std::pow(energy, 1.5f);
+        mapping.brightness = 0.3f + (energy * 0.7f);
+        mapping.damping = 0.2f + ((1.0f - y) * 0.6f);
+
+        float centerFreq = 300.0f;
+        float maxVariation = 200.0f;
+        float variation = (randomValue * 2.0f - 1.0f) * pitchRange * maxVariation;
+        mapping.baseFreq = juce::jlimit(100.0f, 800.0f, centerFreq + variation);
+
+        if (energy > 0.7f)
+            mapping.waveform = ModalVoice::ExcitationWaveform::Square;
+        else if (energy > 0.4f)
+            mapping.waveform = ModalVoice::ExcitationWaveform::Saw;
+        else if (energy > 0.2f)
+            mapping.waveform = ModalVoice::ExcitationWaveform::Noise;
+        else
+            mapping.waveform = ModalVoice::ExcitationWaveform::Sine;
+        return mapping;
+    }
+};
@@ -16,18 +16,10 @@ void PlateSynth::prepare(double sampleRate)
     fadeOutDecay = std::exp(-1.0f / (0.1f * (float)sampleRate));
     
     // Inicializar filtros
-    for (int i = 0; i < NUM_PLATE_MODES; i++)
-    {
-        modes[i].reset();
-    }
-    
-    // Inicializar valores previos
-    prevFreq = currentFreq.load();
-    prevAmp = currentAmp.load();
-    prevMode = currentMode.load();
-    parameterUpdateCounter = 0;
+    modeBank.reset();
     
     // Actualizar coeficientes iniciales
+    lastSeenCoefficientVersion = coefficientVersion.load(std::memory_order_acquire);
     updateFilterCoefficients();
 }
 
@@ -35,9 +27,27 @@ void PlateSynth::prepare(double sampleRate)
 void PlateSynth::triggerPlate(float freq, float amp, int mode)
 {
     // RT-SAFE: Actualizar atomic (llamado desde OSC thread)
-    currentFreq.store(juce::jlimit(20.0f, 2000.0f, freq));
-    currentAmp.store(juce::jlimit(0.0f, 1.0f, amp));
-    currentMode.store(juce::jlimit(0, 7, mode));
+    freq = juce::jlimit(20.0f, 2000.0f, freq);
+    amp = juce::jlimit(0.0f, 1.0f, amp);
+    mode = juce::jlimit(0, 7, mode);
+    
+    // Update incremental: solo escribir lo que cambió; freq/mode invalidan coeficientes
+    bool coefficientsChanged = false;
+    if (std::abs(freq - currentFreq.load(std::memory_order_relaxed)) > FREQ_CHANGE_THRESHOLD_HZ)
+    {
+        currentFreq.store(freq, std::memory_order_relaxed);
+        coefficientsChanged = true;
+    }
+    if (mode != currentMode.load(std::memory_order_relaxed))
+    {
+        currentMode.store(mode, std::memory_order_relaxed);
+        coefficientsChanged = true;
+    }
+    if (amp != currentAmp.load(std::memory_order_relaxed))
+        currentAmp.store(amp, std::memory_order_relaxed);
+    
+    if (coefficientsChanged)
+        coefficientVersion.fetch_add(1, std::memory_order_release);
     
     // Incrementar contador para fail-safe (RT-safe: no syscalls)
     plateUpdateCounter.fetch_add(1, std::memory_order_relaxed);
@@ -49,27 +59,12 @@ void PlateSynth::renderNextBlock(juce::AudioBuffer<float>& buffer, int startSamp
     // RT-SAFE: Verificar timeout y actualizar fade-out
     updateFailSafe(numSamples);
     
-    // RT-SAFE: Actualizar parámetros periódicamente (cada N bloques)
-    parameterUpdateCounter++;
-    if (parameterUpdateCounter >= PARAMETER_UPDATE_INTERVAL)
+    // RT-SAFE: Recalcular coeficientes solo si triggerPlate() registró un cambio de freq/mode
+    uint32_t version = coefficientVersion.load(std::memory_order_acquire);
+    if (version != lastSeenCoefficientVersion)
     {
-        parameterUpdateCounter = 0;
-        
-        // Leer parámetros actuales (atomic, thread-safe)
-        float freq = currentFreq.load();
-        float amp = currentAmp.load();
-        int mode = currentMode.load();
-        
-        // Actualizar coeficientes solo si cambió algo significativamente
-        // Usar umbrales más grandes para reducir actualizaciones innecesarias
-        if (std::abs(freq - prevFreq) > 1.0f ||  // Cambió de 0.1f a 1.0f para reducir updates
-            mode != prevMode)  // Removido check de amp (no afecta coeficientes)
-        {
-            updateFilterCoefficients();
-            prevFreq = freq;
-            prevAmp = amp;
-            prevMode = mode;
-        }
+        lastSeenCoefficientVersion = version;
+        updateFilterCoefficients();
     }
     
     // Leer amplitud actual (atomic, thread-safe)
@@ -83,51 +78,81 @@ void PlateSynth::renderNextBlock(juce::AudioBuffer<float>& buffer, int startSamp
         return;
     }
     
-    // Renderizar para cada canal
-    for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+    // Aplicar fade-out gain una vez (optimización)
+    // Reducir ganancia base del plate para balancear con partículas (0.1 = -20dB aprox)
+    // El plate es inherentemente más fuerte que las partículas, necesita más atenuación
+    float noiseGain = amp * fadeOutGain * 0.1f;
+    float amount = stereoDecorrelation.load(std::memory_order_relaxed);
+    int numChannels = buffer.getNumChannels();
+    
+    // Una sola pasada mono por segmento (ruido + banco de modos) y reparto a los canales
+    for (int pos = 0; pos < numSamples; pos += RENDER_CHUNK)
     {
-        float* channelData = buffer.getWritePointer(channel, startSample);
+        const int len = juce::jmin(RENDER_CHUNK, numSamples - pos);
+        float noise[RENDER_CHUNK];
+        float mono[RENDER_CHUNK];
         
-        // Aplicar fade-out gain una vez (optimización)
-        float effectiveAmp = amp * fadeOutGain;
+        // Generar ruido blanco como excitación (bloque completo, vectorizado)
+        noiseGen.fill(noise, len, noiseGain);
         
-        for (int sample = 0; sample < numSamples; sample++)
-        {
-            // Generar ruido blanco como excitación
-            // Reducir ganancia base del plate para balancear con partículas (0.1 = -20dB aprox)
-            // El plate es inherentemente más fuerte que las partículas, necesita más atenuación
-            float noise = (noiseGen.nextFloat() * 2.0f - 1.0f) * effectiveAmp * 0.1f;
-            
-            // Procesar por cada modo resonante y sumar
-            float output = 0.0f;
-            for (int i = 0; i < NUM_PLATE_MODES; i++)
-            {
-                output += modes[i].process(noise);
-            }
-            
-            // Escribir al buffer
-            channelData[sample] = output;
-        }
+        // Procesar todos los modos resonantes a la vez y sumar
+        modeBank.process(noise, mono, len);
+        
+        for (int channel = 0; channel < numChannels; channel++)
+            decorrelate(channel, mono, buffer.getWritePointer(channel, startSample + pos), len, amount);
+        decorrelationWritePos = (decorrelationWritePos + len) & (DECORRELATION_BUFFER_SIZE - 1);
     }
 }
 
 //==============================================================================
-void PlateSynth::reset()
+void PlateSynth::decorrelate(int channel, const float* mono, float* out, int numSamples, float amount)
 {
-    for (int i = 0; i < NUM_PLATE_MODES; i++)
+    if (channel >= MAX_DECORRELATED_CHANNELS)
+    {
+        juce::FloatVectorOperations::copy(out, mono, numSamples);
+        return;
+    }
+    
+    // Allpass de Schroeder: w = x + g·w[n-D], y = -g·w + w[n-D] (magnitud plana, fase distinta por canal)
+    float* line = decorrelationLines[channel];
+    const int delay = DECORRELATION_DELAYS[channel];
+    const int mask = DECORRELATION_BUFFER_SIZE - 1;
+    int writePos = decorrelationWritePos;
+    for (int i = 0; i < numSamples; i++)
     {
-        modes[i].reset();
+        float delayed = line[(writePos - delay) & mask];
+        float w = mono[i] + DECORRELATION_GAIN * delayed;
+        float allpassed = delayed - DECORRELATION_GAIN * w;
+        line[writePos] = w;
+        writePos = (writePos + 1) & mask;
+        out[i] = mono[i] + amount * (allpassed - mono[i]);
     }
+}
+
+void PlateSynth::setStereoDecorrelation(float amount)
+{
+    stereoDecorrelation.store(juce::jlimit(0.0f, 1.0f, amount), std::memory_order_relaxed);
+}
+
+float PlateSynth::getStereoDecorrelation() const
+{
+    return stereoDecorrelation.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+void PlateSynth::reset()
+{
+    modeBank.reset();
+    for (auto& line : decorrelationLines)
+        juce::FloatVectorOperations::clear(line, DECORRELATION_BUFFER_SIZE);
+    decorrelationWritePos = 0;
     
     fadeOutGain = 1.0f;
-    prevFreq = 220.0f;
-    prevAmp = 0.0f;
-    prevMode = 0;
-    parameterUpdateCounter = 0;
     
     currentFreq.store(220.0f);
     currentAmp.store(0.0f);
     currentMode.store(0);
+    coefficientVersion.fetch_add(1, std::memory_order_release);
     plateUpdateCounter.store(0, std::memory_order_relaxed);
     lastSeenPlateUpdateCounter = 0;
     samplesSinceLastPlateUpdate = 0;
@@ -226,7 +251,7 @@ void PlateSynth::updateFilterCoefficients()
         float modeQ = getModeQ(i);
         
         // Establecer coeficientes del filtro
-        modes[i].setCoefficients(modeFreq, modeQ, modeGain, currentSampleRate);
+        modeBank.setCoefficients(i, modeFreq, modeQ, modeGain, currentSampleRate);
     }
 }
 
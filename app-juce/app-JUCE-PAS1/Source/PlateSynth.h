@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ModalVoice.h"
+#include "NoiseGenerator.h"
 
 //==============================================================================
 /**
@@ -9,6 +11,10 @@
     Implementa síntesis de vibración de placa mediante múltiples modos resonantes
     excitados continuamente por ruido blanco. El sistema incluye fail-safe que
     hace fade-out automático si no se reciben updates en 2 segundos.
+    
+    La placa se renderiza una sola vez por bloque en mono (banco de modos SIMD compartido con
+    ModalVoice) y se reparte a los canales con un allpass de Schroeder distinto por canal
+    (decorrelación configurable): el coste no depende del número de canales de salida.
 */
 class PlateSynth
 {
@@ -21,7 +27,8 @@ public:
     /** Prepara el sintetizador con el sample rate */
     void prepare(double sampleRate);
 
-    /** Actualiza parámetros de la placa (RT-safe: usa atomic) */
+    /** Actualiza parámetros de la placa (RT-safe: usa atomic). Solo los cambios de freq/mode
+        invalidan coeficientes; un /plate idéntico solo refresca el fail-safe. */
     void triggerPlate(float freq, float amp, int mode);
 
     /** Renderiza el siguiente bloque de audio (RT-safe) */
@@ -30,62 +37,27 @@ public:
     /** Resetea el sintetizador completamente */
     void reset();
 
+    /** Decorrelación estéreo 0..1 (0 = misma señal mono en todos los canales). Thread-safe. */
+    void setStereoDecorrelation(float amount);
+    float getStereoDecorrelation() const;
+
+    static constexpr float DEFAULT_DECORRELATION = 1.0f;
+
 private:
     //==============================================================================
     static constexpr int NUM_PLATE_MODES = 6; // Número de modos resonantes
+    static_assert(NUM_PLATE_MODES <= ModalVoice::MODE_LANES, "Los modos de placa deben caber en un ModeBank");
+    static constexpr int RENDER_CHUNK = ModalVoice::RENDER_CHUNK; // Buffers mono en stack
+    
+    // Decorrelación: allpass de Schroeder por canal (delays primos distintos, g fijo)
+    static constexpr int MAX_DECORRELATED_CHANNELS = 8; // Canales extra reciben la señal mono
+    static constexpr int DECORRELATION_BUFFER_SIZE = 128; // Potencia de 2 > delay máximo
+    static constexpr int DECORRELATION_DELAYS[MAX_DECORRELATED_CHANNELS] = { 13, 19, 29, 37, 43, 53, 61, 71 };
+    static constexpr float DECORRELATION_GAIN = 0.6f;
     
     // Timeout para fail-safe (2 segundos)
     static constexpr int failSafeSeconds = 2;
     
-    //==============================================================================
-    struct ResonantFilter
-    {
-        // Coeficientes del filtro biquad (bandpass resonante)
-        float b0, b1, b2, a1, a2;
-        
-        // Estados del filtro (delay line)
-        float x1, x2, y1, y2;
-        
-        void reset()
-        {
-            x1 = x2 = y1 = y2 = 0.0f;
-        }
-        
-        void setCoefficients(float freq, float q, float gain, double sampleRate)
-        {
-            // Diseño de filtro bandpass resonante usando transformación bilineal
-            float w = 2.0f * juce::MathConstants<float>::pi * freq / (float)sampleRate;
-            float cosw = std::cos(w);
-            float sinw = std::sin(w);
-            float alpha = sinw / (2.0f * q);
-            
-            float b0_band = sinw / 2.0f;
-            float b1_band = 0.0f;
-            float b2_band = -sinw / 2.0f;
-            float a0_band = 1.0f + alpha;
-            float a1_band = -2.0f * cosw;
-            float a2_band = 1.0f - alpha;
-            
-            // Normalizar y aplicar ganancia
-            float norm = 1.0f / a0_band;
-            b0 = b0_band * norm * gain;
-            b1 = b1_band * norm * gain;
-            b2 = b2_band * norm * gain;
-            a1 = a1_band * norm;
-            a2 = a2_band * norm;
-        }
-        
-        float process(float input)
-        {
-            float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
-            x2 = x1;
-            x1 = input;
-            y2 = y1;
-            y1 = output;
-            return output;
-        }
-    };
-
     //==============================================================================
     double currentSampleRate = 44100.0;
     
@@ -94,28 +66,31 @@ private:
     std::atomic<float> currentAmp{0.0f};
     std::atomic<int> currentMode{0};
     
+    // Versión de coeficientes: se incrementa solo cuando freq/mode cambian (update incremental)
+    std::atomic<uint32_t> coefficientVersion{0};
+    uint32_t lastSeenCoefficientVersion = 0;
+    static constexpr float FREQ_CHANGE_THRESHOLD_HZ = 1.0f; // Cambios menores no recalculan coeficientes
+    
     // Fail-safe basado en contador de samples (RT-safe)
     std::atomic<uint64_t> plateUpdateCounter{0};
     uint64_t lastSeenPlateUpdateCounter = 0;
     int samplesSinceLastPlateUpdate = 0;
     
-    // Filtros resonantes para cada modo
-    ResonantFilter modes[NUM_PLATE_MODES];
+    // Modos resonantes en SoA (lanes sin usar con coeficientes 0)
+    ModalVoice::ModeBank modeBank;
+    
+    // Estado de decorrelación (solo audio thread)
+    std::atomic<float> stereoDecorrelation{DEFAULT_DECORRELATION};
+    float decorrelationLines[MAX_DECORRELATED_CHANNELS][DECORRELATION_BUFFER_SIZE];
+    int decorrelationWritePos = 0;
     
-    // Excitación: ruido blanco
-    juce::Random noiseGen;
+    // Excitación: ruido blanco por bloques (xorshift en lanes SIMD)
+    NoiseGenerator noiseGen;
     
     // Envolvente de fade-out para fail-safe
     float fadeOutGain = 1.0f;
     float fadeOutDecay = 0.999f; // Ajustar según sample rate
     
-    // Parámetros previos para detectar cambios (RT-safe: solo lectura desde audio thread)
-    float prevFreq = 220.0f;
-    float prevAmp = 0.0f;
-    int prevMode = 0;
-    int parameterUpdateCounter = 0;
-    static constexpr int PARAMETER_UPDATE_INTERVAL = 8; // Actualizar cada 8 bloques (~18ms a 48kHz/512) - reducido para mejor rendimiento
-    
     //==============================================================================
     /** Calcula factores inarmónicos según modo de placa */
     float getInharmonicFactor(int modeIndex, int plateMode) const;
@@ -131,4 +106,7 @@ private:
     
     /** Verifica timeout y actualiza fade-out gain (RT-safe: basado en samples) */
     void updateFailSafe(int numSamples);
+    
+    /** Escribe en out la señal mono pasada por el allpass del canal, mezclada según amount */
+    void decorrelate(int channel, const float* mono, float* out, int numSamples, float amount);
 };
@@ -0,0 +1,217 @@
+#include "ResonatorBank.h"
+
+// setParameters(), addHit() y renderNextBlock() corren en el audio thread: sin locks ni allocations.
+
+//==============================================================================
+ResonatorBank::ResonatorBank()
+{
+    std::fill(std::begin(c1), std::end(c1), 0.0f);
+    std::fill(std::begin(c2), std::end(c2), 0.0f);
+    std::fill(std::begin(inputGain), std::end(inputGain), 0.0f);
+    reset();
+}
+
+//==============================================================================
+void ResonatorBank::prepare(double sampleRate)
+{
+    currentSampleRate = sampleRate;
+    reset();
+    updateCoefficients();
+}
+
+//==============================================================================
+void ResonatorBank::setParameters(float metalness, float brightness, float damping)
+{
+    bool changed = (std::abs(metalness - currentMetalness) > PARAM_CHANGE_THRESHOLD) ||
+                   (std::abs(brightness - currentBrightness) > PARAM_CHANGE_THRESHOLD) ||
+                   (std::abs(damping - currentDamping) > PARAM_CHANGE_THRESHOLD);
+    if (!changed)
+        return;
+
+    currentMetalness = metalness;
+    currentBrightness = brightness;
+    currentDamping = damping;
+    updateCoefficients();
+}
+
+//==============================================================================
+void ResonatorBank::addHit(float baseFreq, float amplitude, float gainL, float gainR)
+{
+    if (amplitude <= 0.0f)
+        return;
+
+    // Slot de pitch más cercano (semitonos sobre MIN_FREQ_HZ)
+    float semitones = 12.0f * std::log2(juce::jmax(1.0f, baseFreq) / MIN_FREQ_HZ);
+    int slot = juce::jlimit(0, NUM_PITCH_SLOTS - 1, juce::roundToInt(semitones));
+
+    // Energía por canal: varios hits en el mismo bloque se suman como en la coalescencia
+    float aL = amplitude * gainL;
+    float aR = amplitude * gainR;
+    channels[0].pendingEnergy[slot] += aL * aL;
+    channels[1].pendingEnergy[slot] += aR * aR;
+    hasPendingEnergy = true;
+    silent = false;
+}
+
+//==============================================================================
+void ResonatorBank::renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (silent || numSamples <= 0)
+        return;
+
+    if (hasPendingEnergy)
+        injectPendingEnergy();
+
+    // Mono: el canal izquierdo recibe la suma de ambos (pan no aplica)
+    int numChannels = buffer.getNumChannels();
+    float peak = 0.0f;
+    if (numChannels >= 2)
+    {
+        peak = juce::jmax(renderChannel(channels[0], buffer.getWritePointer(0, startSample), numSamples),
+                          renderChannel(channels[1], buffer.getWritePointer(1, startSample), numSamples));
+    }
+    else if (numChannels == 1)
+    {
+        float* out = buffer.getWritePointer(0, startSample);
+        peak = juce::jmax(renderChannel(channels[0], out, numSamples),
+                          renderChannel(channels[1], out, numSamples));
+    }
+
+    // Banco dormido: sin coste hasta el próximo hit
+    if (peak < SILENCE_THRESHOLD)
+        reset();
+}
+
+//==============================================================================
+void ResonatorBank::reset()
+{
+    for (auto& channel : channels)
+    {
+        std::fill(std::begin(channel.y1), std::end(channel.y1), 0.0f);
+        std::fill(std::begin(channel.y2), std::end(channel.y2), 0.0f);
+        std::fill(std::begin(channel.pendingEnergy), std::end(channel.pendingEnergy), 0.0f);
+    }
+    silent = true;
+    hasPendingEnergy = false;
+}
+
+//==============================================================================
+void ResonatorBank::updateCoefficients()
+{
+    float metalness = juce::jlimit(0.0f, 1.0f, currentMetalness);
+    float brightness = juce::jlimit(0.0f, 1.0f, currentBrightness);
+    float damping = juce::jlimit(0.0f, 1.0f, currentDamping);
+
+    // Decay como ModalVoice: damping bajo = cola larga (10..500 ms); parciales altos decaen antes
+    float dampingInverted = 1.0f - damping;
+    float decayMs = juce::jmap(dampingInverted * dampingInverted, 0.0f, 1.0f, 10.0f, 500.0f);
+    float metalnessCurve = metalness * metalness;
+    float brightnessCurve = brightness * brightness;
+    float maxFreq = 0.45f * (float)currentSampleRate;
+
+    float partialGain[NUM_PARTIALS];
+    float partialRadius[NUM_PARTIALS];
+    float gainSum = 0.0f;
+    for (int p = 0; p < NUM_PARTIALS; p++)
+    {
+        // Inclinación espectral de brightness (misma curva que ModalVoice::calculateModeGain)
+        float position = (float)p / (float)(NUM_PARTIALS - 1);
+        float gain = PARTIAL_GAINS[p];
+        if (brightnessCurve > 0.5f)
+        {
+            float brightAmount = (brightnessCurve - 0.5f) * 2.0f;
+            gain *= (1.0f - brightAmount * (1.0f - position) * 0.9f) * (1.0f + brightAmount * position * 3.0f);
+        }
+        else
+        {
+            float darkAmount = (0.5f - brightnessCurve) * 2.0f;
+            gain *= (1.0f + darkAmount * (1.0f - position) * 2.0f) * (1.0f - darkAmount * position * 0.8f);
+        }
+        partialGain[p] = gain;
+        gainSum += gain;
+
+        // Radio del polo para caída de 60 dB en t60
+        float t60Samples = decayMs * 0.001f * (float)currentSampleRate / (1.0f + 0.3f * (float)p);
+        partialRadius[p] = std::exp(-6.9078f / juce::jmax(1.0f, t60Samples));
+    }
+
+    // Normalizar: la suma de parciales de un impulso no supera su amplitud
+    for (int p = 0; p < NUM_PARTIALS; p++)
+        partialGain[p] /= juce::jmax(1.0e-3f, gainSum);
+
+    for (int slot = 0; slot < NUM_PITCH_SLOTS; slot++)
+    {
+        float baseFreq = MIN_FREQ_HZ * std::exp2((float)slot / 12.0f);
+        for (int p = 0; p < NUM_PARTIALS; p++)
+        {
+            int r = slot * NUM_PARTIALS + p;
+            float freq = baseFreq * (1.0f + metalnessCurve * (PARTIAL_RATIOS[p] - 1.0f));
+            if (freq >= maxFreq)
+            {
+                c1[r] = c2[r] = inputGain[r] = 0.0f;
+                continue;
+            }
+
+            float sinw, cosw;
+            BiquadTables::sinCos(BiquadTables::omega(freq, currentSampleRate), sinw, cosw);
+            float radius = partialRadius[p];
+            c1[r] = 2.0f * radius * cosw;
+            c2[r] = radius * radius;
+            inputGain[r] = sinw * partialGain[p];
+        }
+    }
+}
+
+//==============================================================================
+void ResonatorBank::injectPendingEnergy()
+{
+    for (auto& channel : channels)
+    {
+        for (int slot = 0; slot < NUM_PITCH_SLOTS; slot++)
+        {
+            float energy = channel.pendingEnergy[slot];
+            if (energy <= 0.0f)
+                continue;
+
+            // Impulso en y[n-1]: equivale a excitar con x = sqrt(ΣE) en el sample anterior al bloque
+            float impulse = std::sqrt(energy);
+            for (int r = slot * NUM_PARTIALS; r < (slot + 1) * NUM_PARTIALS; r++)
+                channel.y1[r] += inputGain[r] * impulse;
+            channel.pendingEnergy[slot] = 0.0f;
+        }
+    }
+    hasPendingEnergy = false;
+}
+
+//==============================================================================
+float ResonatorBank::renderChannel(Channel& channel, float* out, int numSamples)
+{
+    float* y1 = channel.y1;
+    float* y2 = channel.y2;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        // Acumuladores por lane: el bucle interno vectoriza sobre LANES resonadores
+        float acc[LANES] = {};
+        for (int r = 0; r < NUM_RESONATORS; r += LANES)
+        {
+            for (int l = 0; l < LANES; l++)
+            {
+                float y = c1[r + l] * y1[r + l] - c2[r + l] * y2[r + l];
+                y2[r + l] = y1[r + l];
+                y1[r + l] = y;
+                acc[l] += y;
+            }
+        }
+
+        float sum = 0.0f;
+        for (int l = 0; l < LANES; l++)
+            sum += acc[l];
+        out[i] += sum;
+    }
+
+    float peak = 0.0f;
+    for (int r = 0; r < NUM_RESONATORS; r++)
+        peak = juce::jmax(peak, std::abs(y1[r]), std::abs(y2[r]));
+    return peak;
+}
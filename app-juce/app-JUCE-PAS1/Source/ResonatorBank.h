@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadTables.h"
+
+//==============================================================================
+/**
+    Banco de resonadores compartido: modo de motor alternativo a las voces.
+
+    K resonadores fijos (NUM_PITCH_SLOTS alturas en semitonos entre 100 y 800 Hz × NUM_PARTIALS
+    parciales inarmónicos, por canal). Cada hit no crea voz: suma su energía al slot de su pitch
+    en el canal (L/R) según su pan, y al inicio del siguiente bloque cada slot recibe un impulso
+    de amplitud sqrt(ΣE) (misma regla de energía que la coalescencia de eventos).
+    Coste por hit O(1) y por bloque O(K), independiente de la tasa de hits: el techo de polifonía
+    desaparece a cambio de que las colas de hits con el mismo pitch compartan resonador.
+    Timbre global (metalness/brightness/damping); damping/brightness/waveform por hit no aplican.
+*/
+class ResonatorBank
+{
+public:
+    //==============================================================================
+    static constexpr int NUM_PITCH_SLOTS = 37;  // 100..800 Hz (3 octavas) en semitonos
+    static constexpr int NUM_PARTIALS = 6;      // Mismos ratios inarmónicos que ModalVoice
+    static constexpr int LANES = 8;
+    static constexpr int NUM_RESONATORS = ((NUM_PITCH_SLOTS * NUM_PARTIALS + LANES - 1) / LANES) * LANES;
+
+    ResonatorBank();
+    ~ResonatorBank() = default;
+
+    //==============================================================================
+    /** Prepara el banco con el sample rate (rediseña todos los resonadores) */
+    void prepare(double sampleRate);
+
+    /** Timbre global del banco; solo rediseña si cambió algún parámetro. Audio thread, RT-safe. */
+    void setParameters(float metalness, float brightness, float damping);
+
+    /** Acumula la excitación de un hit en su slot de pitch, repartida en L/R. Audio thread, O(1). */
+    void addHit(float baseFreq, float amplitude, float gainL, float gainR);
+
+    /** Suma el banco al buffer (no lo limpia). Audio thread, RT-safe. */
+    void renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /** Silencia todos los resonadores */
+    void reset();
+
+    /** true si ningún resonador suena ni hay excitación pendiente */
+    bool isSilent() const { return silent; }
+
+private:
+    //==============================================================================
+    static constexpr float MIN_FREQ_HZ = 100.0f;
+    static constexpr float SILENCE_THRESHOLD = 1.0e-5f; // |y| por debajo: banco dormido (sin coste)
+    static constexpr float PARAM_CHANGE_THRESHOLD = 0.001f;
+
+    static constexpr float PARTIAL_RATIOS[NUM_PARTIALS] = { 1.0f, 2.76f, 5.40f, 8.93f, 13.34f, 18.65f };
+    static constexpr float PARTIAL_GAINS[NUM_PARTIALS] = { 1.0f, 0.8f, 0.9f, 0.7f, 0.6f, 0.5f };
+
+    // Estado de un canal: resonadores de dos polos y energía pendiente por slot
+    struct Channel
+    {
+        alignas(32) float y1[NUM_RESONATORS];
+        alignas(32) float y2[NUM_RESONATORS];
+        float pendingEnergy[NUM_PITCH_SLOTS];
+    };
+
+    double currentSampleRate = 44100.0;
+    float currentMetalness = -1.0f;
+    float currentBrightness = -1.0f;
+    float currentDamping = -1.0f;
+
+    // Coeficientes compartidos por ambos canales: y[n] = c1*y[n-1] - c2*y[n-2] (+ gain*x)
+    alignas(32) float c1[NUM_RESONATORS];
+    alignas(32) float c2[NUM_RESONATORS];
+    alignas(32) float inputGain[NUM_RESONATORS]; // sin(w)*ganancia: pico de la respuesta ≈ amplitud del impulso
+
+    Channel channels[2];
+    bool silent = true;
+    bool hasPendingEnergy = false;
+
+    //==============================================================================
+    /** Rediseña los K resonadores con el timbre actual (sin/cos por tabla) */
+    void updateCoefficients();
+
+    /** Convierte la energía pendiente en impulsos sobre el estado de los resonadores */
+    void injectPendingEnergy();
+
+    /** Procesa un canal completo; devuelve el pico de |y| al final del bloque */
+    float renderChannel(Channel& channel, float* out, int numSamples);
+};
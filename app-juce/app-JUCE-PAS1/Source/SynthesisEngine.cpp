@@ -1,5 +1,7 @@
 #include "SynthesisEngine.h"
 #include <atomic>
+#include <chrono>
+#include <limits>
 
 // renderNextBlock(), processEventQueue(), and everything they call run on the audio thread
 // and must be RT-safe: no locks, allocations, or logging.
@@ -8,31 +10,44 @@
 SynthesisEngine::SynthesisEngine()
     : plateBuffer(2, MAX_BLOCK_SIZE) // Pre-allocar buffer para 2 canales, tamaño máximo
 {
+    updateMeterWeights();
     reset();
 }
 
 //==============================================================================
-void SynthesisEngine::prepare(double sampleRate)
+void SynthesisEngine::prepare(double sampleRate, int numOutputChannels)
 {
     currentSampleRate = sampleRate;
-    voiceManager.prepare(sampleRate, maxVoices.load());
+    const int poolSize = voicePoolSize.load();
+    if (maxVoices.load() > poolSize)
+        maxVoices.store(poolSize);
+    voiceManager.prepare(sampleRate, maxVoices.load(), poolSize);
     plateSynth.prepare(sampleRate);
+    resonatorBank.prepare(sampleRate);
+    resonatorBank.setParameters(metalness.load(), brightness.load(), damping.load());
+    lookAheadLimiter.prepare(sampleRate);
+    loadMonitor.prepare(sampleRate);
+    samplePosition = 0;
+    numBlockProbes = 0;
     outputLevel = 0.0f;
     
     // Ajustar decay rate del nivel según sample rate
     // Decay de ~100ms
     outputLevelDecay = std::exp(-1.0f / (0.1f * (float)sampleRate));
+    updateMeterWeights();
+    
+    // Drenado adaptativo: coste por trigger se vuelve a medir con el nuevo sample rate
+    ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+    triggerCostTicks = 0.0;
     
     // Preparar buffer de plate (RT-safe: pre-allocar tamaño máximo esperado)
-    // Nota: El tamaño real se ajustará dinámicamente si es necesario, pero esto
-    // debería ser raro ya que prepare() se llama cuando cambia el buffer size
-    plateBuffer.setSize(2, MAX_BLOCK_SIZE, false, false, true);
+    // Un canal por salida: PlateSynth decorrela hasta MAX_DECORRELATED_CHANNELS y copia mono al resto
+    plateBuffer.setSize(juce::jmax(1, numOutputChannels), MAX_BLOCK_SIZE, false, false, true);
     
     // Inicializar valores previos de parámetros globales
     prevMetalness = metalness.load();
     prevBrightness = brightness.load();
     prevDamping = damping.load();
-    parameterUpdateCounter = 0;
     smoothedDensity = 0.0f;
     
     // DIAGNOSTIC: For stability testing, use:
@@ -45,41 +60,60 @@ void SynthesisEngine::prepare(double sampleRate)
 //==============================================================================
 void SynthesisEngine::renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
-    processEventQueue();
-    // Actualizar cada N bloques para eficiencia (evitar actualizar en cada bloque)
-    parameterUpdateCounter++;
-    if (parameterUpdateCounter >= PARAMETER_UPDATE_INTERVAL)
+    // Sin denormales en las colas de resonadores y placa, sea cual sea el host (dispositivo, render, bench)
+    juce::ScopedNoDenormals noDenormals;
+    
+    // Carga por etapa: un tick de alta resolución en cada frontera (plate se acumula por segmento)
+    juce::int64 stageTicks[AudioLoadMonitor::NUM_STAGES] = {};
+    const juce::int64 blockStartTicks = juce::Time::getHighResolutionTicks();
+    
+    // Sondas de latencia: steady_clock es el reloj de t_ns en ISTR (misma máquina). Los eventos se
+    // disparan antes de renderizar, así que cada voz nueva arranca en el sample 0 del bloque.
+    blockCallbackNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    
+    processEventQueue(numSamples);
+    const juce::int64 queueEndTicks = juce::Time::getHighResolutionTicks();
+    stageTicks[AudioLoadMonitor::Queue] = queueEndTicks - blockStartTicks;
+    
+    // Leer parámetros globales (atomic, thread-safe) en cada bloque: el VoiceManager reparte el
+    // rediseño entre bloques y aplica los coeficientes por rampa, así que no hace falta espaciarlos
+    float currentMetalness = metalness.load();
+    float currentBrightness = brightness.load();
+    float currentDamping = damping.load();
+    
+    // Actualizar solo si cambió algún parámetro (optimización)
+    bool needsUpdate = (std::abs(currentMetalness - prevMetalness) > 0.001f) ||
+                      (std::abs(currentBrightness - prevBrightness) > 0.001f) ||
+                      (std::abs(currentDamping - prevDamping) > 0.001f);
+    
+    if (needsUpdate)
     {
-        parameterUpdateCounter = 0;
-        
-        // Leer parámetros globales (atomic, thread-safe)
-        float currentMetalness = metalness.load();
-        float currentBrightness = brightness.load();
-        float currentDamping = damping.load();
-        
-        // Actualizar solo si cambió algún parámetro (optimización)
-        bool needsUpdate = (std::abs(currentMetalness - prevMetalness) > 0.001f) ||
-                          (std::abs(currentBrightness - prevBrightness) > 0.001f) ||
-                          (std::abs(currentDamping - prevDamping) > 0.001f);
+        // Destino de parámetros globales para las voces activas
+        voiceManager.updateGlobalParameters(currentMetalness, currentBrightness, currentDamping);
+        resonatorBank.setParameters(currentMetalness, currentBrightness, currentDamping);
         
-        if (needsUpdate)
-        {
-            // Actualizar parámetros globales en voces activas
-            voiceManager.updateGlobalParameters(currentMetalness, currentBrightness, currentDamping);
-            
-            // Actualizar valores previos
-            prevMetalness = currentMetalness;
-            prevBrightness = currentBrightness;
-            prevDamping = currentDamping;
-        }
-        // M4: Sincronizar flag de carácter al VoiceManager
-        voiceManager.setEnableM4Character(enableM4Character.load());
+        // Actualizar valores previos
+        prevMetalness = currentMetalness;
+        prevBrightness = currentBrightness;
+        prevDamping = currentDamping;
     }
+    // M4: Sincronizar flag de carácter al VoiceManager
+    voiceManager.setEnableM4Character(enableM4Character.load());
     
     // Renderizar voces
+    voiceManager.setVoiceLaneRendering(voiceLaneRendering.load(std::memory_order_relaxed));
+    voiceManager.setSilenceFloor(voiceSilenceFloorDb.load(std::memory_order_relaxed),
+                                 voiceSilenceHoldBlocks.load(std::memory_order_relaxed));
     voiceManager.renderNextBlock(buffer, startSample, numSamples);
 
+    // Banco de resonadores: suma sobre las voces (sin coste si está dormido)
+    resonatorBank.renderNextBlock(buffer, startSample, numSamples);
+    const juce::int64 voicesEndTicks = juce::Time::getHighResolutionTicks();
+    stageTicks[AudioLoadMonitor::Voices] = voicesEndTicks - queueEndTicks;
+
     // M4: Compensación de densidad (gain trim suave para evitar clipping en escenas densas)
+    float gainTrim = 1.0f;
     if (enableDensityCompensation.load())
     {
         int activeCount = voiceManager.getActiveVoiceCount();
@@ -89,76 +123,100 @@ void SynthesisEngine::renderNextBlock(juce::AudioBuffer<float>& buffer, int star
         float alpha = (tauSamples > 0.0f && numSamples > 0)
             ? std::exp(-(float)numSamples / tauSamples) : 0.0f;
         smoothedDensity = alpha * smoothedDensity + (1.0f - alpha) * currentDensity;
-        float gainTrim = 1.0f / std::sqrt(1.0f + M4_KDENSITY * smoothedDensity);
+        gainTrim = 1.0f / std::sqrt(1.0f + M4_KDENSITY * smoothedDensity);
         gainTrim = juce::jlimit(0.25f, 1.0f, gainTrim);
-        for (int ch = 0; ch < buffer.getNumChannels(); ch++)
-        {
-            float* data = buffer.getWritePointer(ch, startSample);
-            for (int i = 0; i < numSamples; i++)
-                data[i] *= gainTrim;
-        }
     }
     
-    // Renderizar plate y sumar al buffer (pre-limiter)
+    // Master bus fusionado: plate (pre-limiter) + trim de densidad + clipper + medidor en una pasada
+    // por canal, por segmentos del tamaño del buffer de plate pre-allocado.
+    // Con el limiter look-ahead la pasada no recorta: el limiter actúa después y el medidor se toma tras él.
+    float currentPlateVolume = plateVolume.load(); // RT-safe: leer atomic
+    bool currentLimiterEnabled = limiterEnabled.load();
+    bool useLookAhead = currentLimiterEnabled && limiterLookAhead.load();
+    if (useLookAhead && !lookAheadWasActive)
+        lookAheadLimiter.reset(); // Sin audio viejo en las delay lines al volver a activarlo
+    lookAheadWasActive = useLookAhead;
+    float clipLevel = (currentLimiterEnabled && !useLookAhead) ? clipperThreshold : std::numeric_limits<float>::max();
     int numChannels = buffer.getNumChannels();
+    int plateChannels = juce::jmin(numChannels, plateBuffer.getNumChannels());
+    float blockPeak = 0.0f;
+    bool lookAheadClipped = false;
     
-    // Limpiar y renderizar plate en buffer temporal
-    // Usar una vista del buffer pre-allocado para el tamaño necesario
-    juce::AudioBuffer<float> plateView(plateBuffer.getArrayOfWritePointers(), 
-                                        juce::jmin(numChannels, plateBuffer.getNumChannels()), 
-                                        0, 
-                                        juce::jmin(numSamples, plateBuffer.getNumSamples()));
-    plateView.clear();
-    plateSynth.renderNextBlock(plateView, 0, plateView.getNumSamples());
-    
-    // Sumar plate a buffer principal (pre-limiter) con control de volumen
-    float currentPlateVolume = plateVolume.load(); // RT-safe: leer atomic
-    int safeSamples = juce::jmin(numSamples, plateView.getNumSamples());
-    int safeChannels = juce::jmin(numChannels, plateView.getNumChannels());
-    for (int channel = 0; channel < safeChannels; channel++)
+    for (int pos = 0; pos < numSamples; pos += MAX_BLOCK_SIZE)
     {
-        float* mainData = buffer.getWritePointer(channel, startSample);
-        const float* plateData = plateView.getReadPointer(channel, 0);
-        for (int sample = 0; sample < safeSamples; sample++)
+        const int len = juce::jmin(MAX_BLOCK_SIZE, numSamples - pos);
+        
+        // Renderizar plate en una vista del buffer pre-allocado
+        juce::AudioBuffer<float> plateView(plateBuffer.getArrayOfWritePointers(), plateChannels, 0, len);
+        const juce::int64 plateStartTicks = juce::Time::getHighResolutionTicks();
+        plateView.clear();
+        plateSynth.renderNextBlock(plateView, 0, len);
+        stageTicks[AudioLoadMonitor::Plate] += juce::Time::getHighResolutionTicks() - plateStartTicks;
+        
+        // Pesos del medidor alineados al final del segmento: weights[i] = decay^(len-1-i)
+        const float* weights = meterWeights.data() + (MAX_BLOCK_SIZE - len);
+        for (int channel = 0; channel < numChannels; channel++)
         {
-            mainData[sample] += plateData[sample] * currentPlateVolume;
+            const float* plateData = channel < plateChannels ? plateView.getReadPointer(channel) : nullptr;
+            float sumSquares = 0.0f;
+            float channelPeak = processMasterChannel(buffer.getWritePointer(channel, startSample + pos), plateData, len,
+                                                     gainTrim, currentPlateVolume, clipLevel, weights, sumSquares);
+            blockPeak = juce::jmax(blockPeak, channelPeak);
+            
+            // Medidor sobre el canal 0 (post-clipper): misma EMA que sample a sample, en forma cerrada
+            if (channel == 0 && !useLookAhead)
+                outputLevel = outputLevel * weights[0] * outputLevelDecay + (1.0f - outputLevelDecay) * sumSquares;
         }
-    }
-    
-    // Aplicar procesamiento master (solo clipper); M3: contar bloques con clipping (una vez por bloque)
-    bool currentLimiterEnabled = limiterEnabled.load();
-    bool blockHadClip = false;
-    for (int channel = 0; channel < buffer.getNumChannels(); channel++)
-    {
-        float* channelData = buffer.getWritePointer(channel, startSample);
-        for (int sample = 0; sample < numSamples; sample++)
+        
+        if (useLookAhead && numChannels > 0)
         {
-            float sampleValue = channelData[sample];
-            if (currentLimiterEnabled)
-            {
-                if (sampleValue > clipperThreshold || sampleValue < -clipperThreshold)
-                    blockHadClip = true;
-                sampleValue = applyClipper(sampleValue);
-            }
-            channelData[sample] = sampleValue;
-            if (channel == 0)
-                updateOutputLevel(sampleValue);
+            lookAheadClipped = lookAheadLimiter.process(buffer, startSample + pos, len, clipperThreshold) || lookAheadClipped;
+            
+            const float* data = buffer.getReadPointer(0, startSample + pos);
+            float sumSquares = 0.0f;
+            for (int i = 0; i < len; i++)
+                sumSquares += data[i] * data[i] * weights[i];
+            outputLevel = outputLevel * weights[0] * outputLevelDecay + (1.0f - outputLevelDecay) * sumSquares;
         }
     }
-    if (blockHadClip)
+    
+    // M3: contar bloques con clipping (una vez por bloque). Con look-ahead solo cuenta si actuó el
+    // recorte de seguridad (la estimación true-peak se quedó corta)
+    bool blockClipped = useLookAhead ? lookAheadClipped : (currentLimiterEnabled && blockPeak > clipperThreshold);
+    if (blockClipped)
         blocksClippedCount.fetch_add(1, std::memory_order_relaxed);
+    
+    const juce::int64 blockEndTicks = juce::Time::getHighResolutionTicks();
+    stageTicks[AudioLoadMonitor::Master] = (blockEndTicks - voicesEndTicks) - stageTicks[AudioLoadMonitor::Plate];
+    stageTicks[AudioLoadMonitor::Total] = blockEndTicks - blockStartTicks;
+    loadMonitor.recordBlock(stageTicks, numSamples);
+    
+    if (numBlockProbes > 0)
+    {
+        const double budgetTicks = ticksPerSecond * (double)numSamples / currentSampleRate;
+        publishLatencyProbes((float)((double)stageTicks[AudioLoadMonitor::Total] / budgetTicks),
+                             useLookAhead ? lookAheadLimiter.getLatencySamples() : 0, numSamples);
+    }
+    samplePosition += numSamples;
 }
 
 //==============================================================================
 void SynthesisEngine::setMaxVoices(int newMaxVoices)
 {
-    int limitedVoices = juce::jlimit(4, 24, newMaxVoices);
+    int limitedVoices = juce::jlimit(4, voicePoolSize.load(), newMaxVoices);
     maxVoices.store(limitedVoices);
     
-    // Actualizar VoiceManager (esto es seguro porque se llama desde UI thread)
+    // Actualizar VoiceManager (atomic; el cambio de layout se aplica en el audio thread)
     voiceManager.setMaxVoices(limitedVoices);
 }
 
+void SynthesisEngine::setVoicePoolSize(int poolSize)
+{
+    voicePoolSize.store(juce::jlimit(4, VoiceManager::MAX_POOL_SIZE, poolSize));
+    if (maxVoices.load() > voicePoolSize.load())
+        setMaxVoices(voicePoolSize.load());
+}
+
 void SynthesisEngine::setMetalness(float newMetalness)
 {
     metalness.store(juce::jlimit(0.0f, 1.0f, newMetalness));
@@ -194,17 +252,59 @@ void SynthesisEngine::setLimiterEnabled(bool enabled)
     limiterEnabled.store(enabled);
 }
 
+void SynthesisEngine::setLimiterLookAhead(bool enabled)
+{
+    limiterLookAhead.store(enabled);
+}
+
+void SynthesisEngine::setLimiterLookaheadMs(float ms)
+{
+    lookAheadLimiter.setLookaheadMs(ms);
+}
+
 void SynthesisEngine::setPlateVolume(float volume)
 {
     plateVolume.store(juce::jlimit(0.0f, 1.0f, volume));
 }
 
+void SynthesisEngine::setPlateDecorrelation(float amount)
+{
+    plateSynth.setStereoDecorrelation(amount);
+}
+
+void SynthesisEngine::setVoiceLaneRendering(bool enabled)
+{
+    voiceLaneRendering.store(enabled);
+}
+
+void SynthesisEngine::setVoiceRenderThreads(int numThreads, bool waitForThreads)
+{
+    // Thread-safe en VoiceManager: crea los workers que falten y cambia cuántos participan
+    voiceManager.setRenderWorkers(numThreads, waitForThreads);
+}
+
+void SynthesisEngine::setResonatorBankMode(bool enabled)
+{
+    resonatorBankMode.store(enabled);
+}
+
+void SynthesisEngine::setVoiceSilenceFloor(float floorDb, int holdBlocks)
+{
+    voiceSilenceFloorDb.store(juce::jlimit(-140.0f, -40.0f, floorDb));
+    voiceSilenceHoldBlocks.store(juce::jlimit(1, 64, holdBlocks));
+}
+
 //==============================================================================
 int SynthesisEngine::getMaxVoices() const
 {
     return maxVoices.load();
 }
 
+int SynthesisEngine::getVoicePoolSize() const
+{
+    return voicePoolSize.load();
+}
+
 float SynthesisEngine::getMetalness() const
 {
     return metalness.load();
@@ -240,11 +340,56 @@ bool SynthesisEngine::isLimiterEnabled() const
     return limiterEnabled.load();
 }
 
+bool SynthesisEngine::isLimiterLookAhead() const
+{
+    return limiterLookAhead.load();
+}
+
+float SynthesisEngine::getLimiterLookaheadMs() const
+{
+    return lookAheadLimiter.getLookaheadMs();
+}
+
+int SynthesisEngine::getLimiterLatencySamples() const
+{
+    return (limiterEnabled.load() && limiterLookAhead.load()) ? lookAheadLimiter.getLatencySamples() : 0;
+}
+
 float SynthesisEngine::getPlateVolume() const
 {
     return plateVolume.load();
 }
 
+float SynthesisEngine::getPlateDecorrelation() const
+{
+    return plateSynth.getStereoDecorrelation();
+}
+
+bool SynthesisEngine::isVoiceLaneRendering() const
+{
+    return voiceLaneRendering.load();
+}
+
+float SynthesisEngine::getVoiceSilenceFloorDb() const
+{
+    return voiceSilenceFloorDb.load();
+}
+
+int SynthesisEngine::getVoiceSilenceHoldBlocks() const
+{
+    return voiceSilenceHoldBlocks.load();
+}
+
+int SynthesisEngine::getVoiceRenderThreads() const
+{
+    return voiceManager.getRenderWorkers();
+}
+
+bool SynthesisEngine::isResonatorBankMode() const
+{
+    return resonatorBankMode.load();
+}
+
 //==============================================================================
 void SynthesisEngine::triggerTestVoice()
 {
@@ -258,6 +403,8 @@ void SynthesisEngine::triggerTestVoice()
     event.metalness = metalness.load();
     event.waveform = static_cast<ModalVoice::ExcitationWaveform>(waveform.load());
     event.subOscMix = subOscMix.load();
+    event.enqueueTimeMs = juce::Time::getMillisecondCounter();
+    event.probeSendNs = 0;
     
     int start1, size1, start2, size2;
     eventFifo.prepareToWrite(1, start1, size1, start2, size2);
@@ -280,7 +427,7 @@ void SynthesisEngine::incrementHitsReceived()
 void SynthesisEngine::triggerVoiceFromOSC(float baseFreq, float amplitude, 
                                          float damping, float brightness, float metalness,
                                          ModalVoice::ExcitationWaveform waveform,
-                                         float subOscMix)
+                                         float subOscMix, juce::int64 probeSendNs)
 {
     hitsReceived.fetch_add(1, std::memory_order_relaxed);
     
@@ -293,6 +440,8 @@ void SynthesisEngine::triggerVoiceFromOSC(float baseFreq, float amplitude,
     event.metalness = metalness;
     event.waveform = waveform;
     event.subOscMix = subOscMix;
+    event.enqueueTimeMs = juce::Time::getMillisecondCounter();
+    event.probeSendNs = probeSendNs;
     
     int start1, size1, start2, size2;
     eventFifo.prepareToWrite(1, start1, size1, start2, size2);
@@ -326,15 +475,24 @@ void SynthesisEngine::reset()
 {
     voiceManager.resetAll();
     plateSynth.reset();
+    resonatorBank.reset();
+    lookAheadLimiter.reset();
     outputLevel = 0.0f;
     smoothedDensity = 0.0f;
     hitsReceived.store(0, std::memory_order_relaxed);
     hitsTriggered.store(0, std::memory_order_relaxed);
     hitsDiscarded.store(0, std::memory_order_relaxed);
+    hitsCoalesced.store(0, std::memory_order_relaxed);
+    peakQueueFillPermille.store(0, std::memory_order_relaxed);
     fusedHitsEnqueued.store(0, std::memory_order_relaxed);
     fusedHitsDiscardedQueue.store(0, std::memory_order_relaxed);
     blocksClippedCount.store(0, std::memory_order_relaxed);
+    loadMonitor.reset();
     fusedFifo.reset();
+    probeFifo.reset();
+    numBlockProbes = 0;
+    samplePosition = 0;
+    latencyProbesDropped.store(0, std::memory_order_relaxed);
 }
 
 //==============================================================================
@@ -392,6 +550,7 @@ bool SynthesisEngine::enqueueFusedSnapshot(const FusedHitSnapshot& snapshot)
     if (size1 > 0)
     {
         fusedQueue[start1] = snapshot;
+        fusedQueue[start1].enqueueTimeMs = juce::Time::getMillisecondCounter();
         fusedFifo.finishedWrite(size1);
         fusedHitsEnqueued.fetch_add(1, std::memory_order_relaxed);
         return true;
@@ -410,11 +569,73 @@ int SynthesisEngine::getFusedHitsDiscardedQueue() const
     return fusedHitsDiscardedQueue.load(std::memory_order_relaxed);
 }
 
+float SynthesisEngine::getAndResetPeakQueueFill()
+{
+    return (float)peakQueueFillPermille.exchange(0, std::memory_order_relaxed) / 1000.0f;
+}
+
+int SynthesisEngine::getHitsCoalesced() const
+{
+    return hitsCoalesced.load(std::memory_order_relaxed);
+}
+
 int SynthesisEngine::getBlocksClippedCount() const
 {
     return blocksClippedCount.load(std::memory_order_relaxed);
 }
 
+AudioLoadMonitor::Snapshot SynthesisEngine::takeLoadSnapshot()
+{
+    return loadMonitor.takeSnapshot();
+}
+
+//==============================================================================
+int SynthesisEngine::popLatencyProbes(LatencyProbe* out, int maxCount)
+{
+    int start1, size1, start2, size2;
+    probeFifo.prepareToRead(maxCount, start1, size1, start2, size2);
+    for (int i = 0; i < size1; i++)
+        out[i] = probeQueue[start1 + i];
+    for (int i = 0; i < size2; i++)
+        out[size1 + i] = probeQueue[start2 + i];
+    probeFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+int SynthesisEngine::getLatencyProbesDropped() const
+{
+    return latencyProbesDropped.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+void SynthesisEngine::publishLatencyProbes(float blockLoad, int latencySamples, int numSamples)
+{
+    const int activeVoices = voiceManager.getActiveVoiceCount();
+    for (int i = 0; i < numBlockProbes; i++)
+    {
+        LatencyProbe& p = blockProbes[i];
+        p.callbackNs = blockCallbackNs;
+        p.triggerSample = samplePosition;
+        p.blockSize = numSamples;
+        p.latencySamples = latencySamples;
+        p.activeVoices = activeVoices;
+        p.blockLoad = blockLoad;
+    }
+    
+    int start1, size1, start2, size2;
+    probeFifo.prepareToWrite(numBlockProbes, start1, size1, start2, size2);
+    for (int i = 0; i < size1; i++)
+        probeQueue[start1 + i] = blockProbes[i];
+    for (int i = 0; i < size2; i++)
+        probeQueue[start2 + i] = blockProbes[size1 + i];
+    probeFifo.finishedWrite(size1 + size2);
+    
+    // Cola llena (message thread sin drenar): se pierden las sondas, nunca el audio
+    if (size1 + size2 < numBlockProbes)
+        latencyProbesDropped.fetch_add(numBlockProbes - size1 - size2, std::memory_order_relaxed);
+    numBlockProbes = 0;
+}
+
 //==============================================================================
 void SynthesisEngine::triggerPlateFromOSC(float freq, float amp, int mode)
 {
@@ -422,79 +643,239 @@ void SynthesisEngine::triggerPlateFromOSC(float freq, float amp, int mode)
 }
 
 //==============================================================================
-float SynthesisEngine::applyClipper(float sample)
+float SynthesisEngine::processMasterChannel(float* data, const float* plateData, int numSamples,
+                                            float voiceGain, float plateGain, float clipLevel,
+                                            const float* weights, float& weightedSumSquares)
+{
+    // Loops sin branches por sample: el compilador los vectoriza. Recorte duro simétrico
+    // (equivale a sample * threshold / |sample|) y pico pre-clipper para el contador M3.
+    // Todos los canales acumulan el medidor (evita otra variante del loop); solo se usa el canal 0.
+    float peak = 0.0f;
+    float sum = 0.0f;
+    if (plateData != nullptr)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            float x = data[i] * voiceGain + plateData[i] * plateGain;
+            peak = juce::jmax(peak, std::abs(x));
+            x = juce::jlimit(-clipLevel, clipLevel, x);
+            data[i] = x;
+            sum += x * x * weights[i];
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            float x = data[i] * voiceGain;
+            peak = juce::jmax(peak, std::abs(x));
+            x = juce::jlimit(-clipLevel, clipLevel, x);
+            data[i] = x;
+            sum += x * x * weights[i];
+        }
+    }
+    weightedSumSquares = sum;
+    return peak;
+}
+
+//==============================================================================
+int SynthesisEngine::computeDrainBudget(int numSamples) const
 {
-    float absSample = sample >= 0.0f ? sample : -sample;
-    if (absSample > clipperThreshold)
-        return sample * (clipperThreshold / absSample);
-    return sample;
+    if (triggerCostTicks <= 0.0)
+        return INITIAL_HITS_PER_BLOCK;
+    
+    double blockTicks = (double)numSamples / currentSampleRate * ticksPerSecond;
+    int budget = (int)(blockTicks * DRAIN_BLOCK_FRACTION / triggerCostTicks);
+    return juce::jlimit(MIN_HITS_PER_BLOCK, EVENT_QUEUE_SIZE + FUSED_QUEUE_SIZE, budget);
 }
 
 //==============================================================================
-void SynthesisEngine::processEventQueue()
+void SynthesisEngine::triggerSnapshot(const FusedHitSnapshot& s, bool usePan, bool coalesced)
 {
-    // 1) M2 fused: constant-power stereo pan (gL/gR from snapshot) applied in VoiceManager mix stage
-    int fusedAvailable = fusedFifo.getNumReady();
-    int fusedToRead = juce::jmin(MAX_HITS_PER_BLOCK, fusedAvailable);
-    if (fusedToRead > 0)
+    if (s.probeSendNs != 0)
     {
-        int start1, size1, start2, size2;
-        fusedFifo.prepareToRead(fusedToRead, start1, size1, start2, size2);
-        for (int i = 0; i < size1; i++)
+        if (numBlockProbes < MAX_PROBES_PER_BLOCK)
         {
-            const FusedHitSnapshot& s = fusedQueue[start1 + i];
-            auto wf = static_cast<ModalVoice::ExcitationWaveform>(juce::jlimit(0, 6, s.waveformAsInt));
-            voiceManager.triggerVoice(s.baseFreq, s.amplitude, s.damping, s.brightness, s.metalness,
-                                     wf, s.subOscMix, s.gainL, s.gainR, s.quadrant);
-            hitsTriggered.fetch_add(1, std::memory_order_relaxed);
+            LatencyProbe& p = blockProbes[numBlockProbes++];
+            p.sendNs = s.probeSendNs;
+            p.fused = usePan; // Solo los eventos de la cola fusionada llevan pan
+            p.coalesced = coalesced;
         }
-        for (int i = 0; i < size2; i++)
+        else
         {
-            const FusedHitSnapshot& s = fusedQueue[start2 + i];
-            auto wf = static_cast<ModalVoice::ExcitationWaveform>(juce::jlimit(0, 6, s.waveformAsInt));
-            voiceManager.triggerVoice(s.baseFreq, s.amplitude, s.damping, s.brightness, s.metalness,
-                                     wf, s.subOscMix, s.gainL, s.gainR, s.quadrant);
-            hitsTriggered.fetch_add(1, std::memory_order_relaxed);
+            latencyProbesDropped.fetch_add(1, std::memory_order_relaxed);
         }
-        fusedFifo.finishedRead(size1 + size2);
     }
-    
-    // 2) Drenar cola de hits crudos (mono: gainL/gainR = 1)
-    int available = eventFifo.getNumReady();
-    if (available == 0)
+
+    if (resonatorBankMode.load(std::memory_order_relaxed))
+    {
+        // O(1): solo acumula energía en el slot de pitch; el banco la inyecta al renderizar
+        resonatorBank.addHit(s.baseFreq, s.amplitude, usePan ? s.gainL : 1.0f, usePan ? s.gainR : 1.0f);
         return;
+    }
+
+    auto wf = static_cast<ModalVoice::ExcitationWaveform>(juce::jlimit(0, 6, s.waveformAsInt));
+    if (usePan)
+        voiceManager.triggerVoice(s.baseFreq, s.amplitude, s.damping, s.brightness, s.metalness,
+                                  wf, s.subOscMix, s.gainL, s.gainR, s.quadrant);
+    else
+        voiceManager.triggerVoice(s.baseFreq, s.amplitude, s.damping, s.brightness, s.metalness,
+                                  wf, s.subOscMix, 1.0f, 1.0f);
+}
+
+//==============================================================================
+void SynthesisEngine::coalesceEvent(CoalesceBucket& bucket, const FusedHitSnapshot& event)
+{
+    // Misma regla de energía que HitAggregator: E = sum(a^2), a_out = sqrt(E)
+    bucket.sumE += event.amplitude * event.amplitude;
+    if (bucket.count == 0 || event.amplitude > bucket.peakAmplitude)
+    {
+        bucket.peak = event;
+        bucket.peakAmplitude = event.amplitude;
+    }
+    if (event.probeSendNs != 0 && (bucket.probeSendNs == 0 || event.probeSendNs < bucket.probeSendNs))
+        bucket.probeSendNs = event.probeSendNs;
+    bucket.count++;
+}
+
+//==============================================================================
+void SynthesisEngine::flushCoalesceBuckets(CoalesceBucket* buckets, bool usePan)
+{
+    for (int r = 0; r < NUM_COALESCE_REGIONS; r++)
+    {
+        CoalesceBucket& b = buckets[r];
+        if (b.count == 0)
+            continue;
+        
+        FusedHitSnapshot merged = b.peak;
+        merged.amplitude = juce::jmin(1.0f, std::sqrt(b.sumE));
+        merged.probeSendNs = b.probeSendNs;
+        triggerSnapshot(merged, usePan, true);
+        // Una sola voz: cuenta 1 disparo; los eventos absorbidos solo suman a hitsCoalesced
+        hitsTriggered.fetch_add(1, std::memory_order_relaxed);
+        hitsCoalesced.fetch_add(b.count, std::memory_order_relaxed);
+        
+        b.count = 0;
+        b.sumE = 0.0f;
+        b.peakAmplitude = 0.0f;
+        b.probeSendNs = 0;
+    }
+}
+
+//==============================================================================
+void SynthesisEngine::processEventQueue(int numSamples)
+{
+    // Drenado adaptativo: la cola se vacía completa en cada bloque. Los primeros eventos (hasta el
+    // presupuesto derivado del coste medido por trigger) se disparan individualmente; los eventos
+    // viejos o fuera de presupuesto se coalescen por región en un único trigger, así la latencia
+    // queda acotada a un bloque en ráfagas en lugar de acumular backlog.
+    const int budget = computeDrainBudget(numSamples);
+    const juce::uint32 nowMs = juce::Time::getMillisecondCounter();
+    int triggeredIndividually = 0;
+    juce::int64 individualTicks = 0; // Solo los triggers individuales (sin coalescencia ni flush)
     
-    int numToRead = juce::jmin(MAX_HITS_PER_BLOCK, available);
-    if (available > MAX_HITS_PER_BLOCK * 2)
-        numToRead = MAX_HITS_PER_BLOCK / 2;
+    // Pico de ocupación antes de drenar (feedback /load hacia ISTR)
+    int fillPermille = juce::jmax(fusedFifo.getNumReady() * 1000 / FUSED_QUEUE_SIZE,
+                                  eventFifo.getNumReady() * 1000 / EVENT_QUEUE_SIZE);
+    if (fillPermille > peakQueueFillPermille.load(std::memory_order_relaxed))
+        peakQueueFillPermille.store(fillPermille, std::memory_order_relaxed);
     
-    int start1, size1, start2, size2;
-    eventFifo.prepareToRead(numToRead, start1, size1, start2, size2);
+    // 1) M2 fused: constant-power stereo pan (gL/gR from snapshot) applied in VoiceManager mix stage
+    int fusedAvailable = fusedFifo.getNumReady();
+    if (fusedAvailable > 0)
+    {
+        int start1, size1, start2, size2;
+        fusedFifo.prepareToRead(fusedAvailable, start1, size1, start2, size2);
+        auto drainFused = [&](int start, int size)
+        {
+            for (int i = 0; i < size; i++)
+            {
+                const FusedHitSnapshot& s = fusedQueue[start + i];
+                bool stale = (nowMs - s.enqueueTimeMs) > STALE_EVENT_MS;
+                if (!stale && triggeredIndividually < budget)
+                {
+                    const juce::int64 t0 = juce::Time::getHighResolutionTicks();
+                    triggerSnapshot(s, true);
+                    individualTicks += juce::Time::getHighResolutionTicks() - t0;
+                    hitsTriggered.fetch_add(1, std::memory_order_relaxed);
+                    triggeredIndividually++;
+                }
+                else
+                {
+                    int region = (s.quadrant >= 0 && s.quadrant < NUM_COALESCE_REGIONS) ? s.quadrant : 0;
+                    coalesceEvent(fusedBuckets[region], s);
+                }
+            }
+        };
+        drainFused(start1, size1);
+        drainFused(start2, size2);
+        fusedFifo.finishedRead(size1 + size2);
+    }
     
-    for (int i = 0; i < size1; i++)
+    // 2) Drenar cola de hits crudos (mono: gainL/gainR = 1); región = banda de pitch
+    int available = eventFifo.getNumReady();
+    if (available > 0)
     {
-        const HitEvent& event = eventQueue[start1 + i];
-        voiceManager.triggerVoice(event.baseFreq, event.amplitude,
-                                   event.damping, event.brightness, event.metalness,
-                                   event.waveform, event.subOscMix, 1.0f, 1.0f);
-        hitsTriggered.fetch_add(1, std::memory_order_relaxed);
+        int start1, size1, start2, size2;
+        eventFifo.prepareToRead(available, start1, size1, start2, size2);
+        auto drainRaw = [&](int start, int size)
+        {
+            for (int i = 0; i < size; i++)
+            {
+                const HitEvent& event = eventQueue[start + i];
+                FusedHitSnapshot s;
+                s.baseFreq = event.baseFreq;
+                s.amplitude = event.amplitude;
+                s.damping = event.damping;
+                s.brightness = event.brightness;
+                s.metalness = event.metalness;
+                s.waveformAsInt = static_cast<int>(event.waveform);
+                s.subOscMix = event.subOscMix;
+                s.probeSendNs = event.probeSendNs;
+                
+                bool stale = (nowMs - event.enqueueTimeMs) > STALE_EVENT_MS;
+                if (!stale && triggeredIndividually < budget)
+                {
+                    const juce::int64 t0 = juce::Time::getHighResolutionTicks();
+                    triggerSnapshot(s, false);
+                    individualTicks += juce::Time::getHighResolutionTicks() - t0;
+                    hitsTriggered.fetch_add(1, std::memory_order_relaxed);
+                    triggeredIndividually++;
+                }
+                else
+                {
+                    float bandPos = (event.baseFreq - 100.0f) / 700.0f;
+                    int region = juce::jlimit(0, NUM_COALESCE_REGIONS - 1, (int)(bandPos * NUM_COALESCE_REGIONS));
+                    coalesceEvent(rawBuckets[region], s);
+                }
+            }
+        };
+        drainRaw(start1, size1);
+        drainRaw(start2, size2);
+        eventFifo.finishedRead(size1 + size2);
     }
-    for (int i = 0; i < size2; i++)
+    
+    // Medir coste por trigger (EMA) solo con los triggers individuales
+    if (triggeredIndividually > 0)
     {
-        const HitEvent& event = eventQueue[start2 + i];
-        voiceManager.triggerVoice(event.baseFreq, event.amplitude,
-                                   event.damping, event.brightness, event.metalness,
-                                   event.waveform, event.subOscMix, 1.0f, 1.0f);
-        hitsTriggered.fetch_add(1, std::memory_order_relaxed);
+        double measured = (double)individualTicks / (double)triggeredIndividually;
+        triggerCostTicks = (triggerCostTicks <= 0.0) ? measured : (0.9 * triggerCostTicks + 0.1 * measured);
     }
     
-    eventFifo.finishedRead(size1 + size2);
+    // 3) Un trigger por región con eventos coalescidos (acotado a 2 * NUM_COALESCE_REGIONS)
+    flushCoalesceBuckets(fusedBuckets, true);
+    flushCoalesceBuckets(rawBuckets, false);
 }
 
 //==============================================================================
-void SynthesisEngine::updateOutputLevel(float sample)
+void SynthesisEngine::updateMeterWeights()
 {
-    // RMS aproximado con decay exponencial
-    float squared = sample * sample;
-    outputLevel = outputLevel * outputLevelDecay + squared * (1.0f - outputLevelDecay);
+    // weights[k] = decay^(MAX_BLOCK_SIZE-1-k): la EMA de N samples es un producto escalar con la cola
+    meterWeights.resize((size_t)MAX_BLOCK_SIZE);
+    float w = 1.0f;
+    for (int k = MAX_BLOCK_SIZE - 1; k >= 0; k--)
+    {
+        meterWeights[(size_t)k] = w;
+        w *= outputLevelDecay;
+    }
 }
@@ -3,6 +3,9 @@
 #include <JuceHeader.h>
 #include "VoiceManager.h"
 #include "PlateSynth.h"
+#include "ResonatorBank.h"
+#include "LookAheadLimiter.h"
+#include "AudioLoadMonitor.h"
 #include "FusedHitSnapshot.h"
 
 //==============================================================================
@@ -24,6 +27,23 @@ public:
         float metalness;
         ModalVoice::ExcitationWaveform waveform;
         float subOscMix;
+        juce::uint32 enqueueTimeMs; // Time::getMillisecondCounter() al encolar (detección de eventos viejos)
+        juce::int64 probeSendNs;    // t_ns del /hit instrumentado (0 = sin sonda)
+    };
+
+    /** Sonda de latencia hit → sonido: una por trigger de un evento con probeSendNs.
+     *  Tiempos en ns de std::chrono::steady_clock (el reloj de ISTR en la misma máquina). */
+    struct LatencyProbe
+    {
+        juce::int64 sendNs;         // t_ns del /hit (generateHitEvent en ISTR)
+        juce::int64 callbackNs;     // Entrada a renderNextBlock del bloque que disparó la voz
+        juce::int64 triggerSample;  // Posición absoluta (samples desde prepare) del primer sample de la voz
+        int blockSize;
+        int latencySamples;         // Latencia interna tras el trigger (limiter look-ahead)
+        int activeVoices;           // Voces activas al cerrar el bloque
+        float blockLoad;            // Carga total del bloque (fracción del presupuesto)
+        bool fused;                 // Evento fusionado por HitAggregator (la sonda es su /hit más antiguo)
+        bool coalesced;             // Disparado dentro de un trigger coalescido
     };
 
     //==============================================================================
@@ -31,15 +51,19 @@ public:
     ~SynthesisEngine() = default;
 
     //==============================================================================
-    /** Prepara el motor con el sample rate */
-    void prepare(double sampleRate);
+    /** Prepara el motor con el sample rate y el número de canales de salida (dimensiona el buffer de plate) */
+    void prepare(double sampleRate, int numOutputChannels = 2);
 
     /** Renderiza el siguiente bloque de audio */
     void renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
 
     //==============================================================================
     /** Parámetros globales (thread-safe usando atomic) */
+    /** Voces simultáneas, limitadas al pool de voces (getVoicePoolSize) */
     void setMaxVoices(int maxVoices);
+    /** Tamaño del pool de voces pre-allocado (4..VoiceManager::MAX_POOL_SIZE, default 256). Message
+     *  thread; se aplica en el próximo prepare() y reduce maxVoices si queda por encima. */
+    void setVoicePoolSize(int poolSize);
     void setMetalness(float metalness);
     void setBrightness(float brightness);
     void setDamping(float damping);
@@ -47,10 +71,26 @@ public:
     void setSubOscMix(float subOscMix);
     void setPitchRange(float pitchRange);
     void setLimiterEnabled(bool enabled);
+    /** Limiter look-ahead true-peak en lugar del clipper por sample (añade latencia). Default OFF. */
+    void setLimiterLookAhead(bool enabled);
+    /** Look-ahead del limiter en ms (0.25-5). Se aplica en el audio thread al siguiente bloque. */
+    void setLimiterLookaheadMs(float ms);
     void setPlateVolume(float volume);
+    /** Decorrelación entre canales de la placa (0 = mono idéntico en todos, 1 = allpass por canal; default 1) */
+    void setPlateDecorrelation(float amount);
+    /** Render voices-across-lanes (SIMD entre voces) o por voz. Default ON. */
+    void setVoiceLaneRendering(bool enabled);
+    /** Fin temprano de voces: piso en dBFS y bloques seguidos bajo el piso antes de terminar la cola. */
+    void setVoiceSilenceFloor(float floorDb, int holdBlocks);
+    /** Hilos auxiliares para render de voces en paralelo (0 = solo audio thread, default). Los hilos se crean
+     *  al pedirlos. waitForThreads = true para render offline (sin plazo por bloque). Message thread. */
+    void setVoiceRenderThreads(int numThreads, bool waitForThreads = false);
+    /** Modo banco de resonadores: los hits excitan un banco fijo en lugar de disparar voces. Default OFF. */
+    void setResonatorBankMode(bool enabled);
 
     /** Obtiene parámetros actuales */
     int getMaxVoices() const;
+    int getVoicePoolSize() const;
     float getMetalness() const;
     float getBrightness() const;
     float getDamping() const;
@@ -58,7 +98,17 @@ public:
     float getSubOscMix() const;
     float getPitchRange() const;
     bool isLimiterEnabled() const;
+    bool isLimiterLookAhead() const;
+    float getLimiterLookaheadMs() const;
+    /** Latencia del limiter look-ahead en samples (0 con el clipper) */
+    int getLimiterLatencySamples() const;
     float getPlateVolume() const;
+    float getPlateDecorrelation() const;
+    bool isVoiceLaneRendering() const;
+    float getVoiceSilenceFloorDb() const;
+    int getVoiceSilenceHoldBlocks() const;
+    int getVoiceRenderThreads() const;
+    bool isResonatorBankMode() const;
 
     //==============================================================================
     /** Trigger manual de una voz (para testing sin OSC) - RT-safe: escribe a cola */
@@ -67,11 +117,11 @@ public:
     /** Incrementa hits recibidos (usado cuando agregación está activa: contar raw antes de agregar). */
     void incrementHitsReceived();
 
-    /** Trigger voz desde OSC - RT-safe: escribe a cola lock-free */
+    /** Trigger voz desde OSC - RT-safe: escribe a cola lock-free. probeSendNs: t_ns del /hit instrumentado. */
     void triggerVoiceFromOSC(float baseFreq, float amplitude, 
                              float damping, float brightness, float metalness,
                              ModalVoice::ExcitationWaveform waveform = ModalVoice::ExcitationWaveform::Noise,
-                             float subOscMix = 0.0f);
+                             float subOscMix = 0.0f, juce::int64 probeSendNs = 0);
 
     /** Trigger plate desde OSC - RT-safe: actualiza atomic */
     void triggerPlateFromOSC(float freq, float amp, int mode);
@@ -86,35 +136,59 @@ public:
     int getHitsReceived() const;
     int getHitsTriggered() const;
     int getHitsDiscarded() const;
-    float getHitCoverageRatio() const; // hits_triggered / hits_received
+    float getHitCoverageRatio() const; // hits_triggered / hits_received (un trigger coalescido cuenta 1)
 
     /** Encola un evento fusionado (message thread). Returns true si se encoló; false si cola llena (drop-new). */
     bool enqueueFusedSnapshot(const FusedHitSnapshot& snapshot);
 
+    /** Pico de ocupación de colas (0..1) observado al drenar desde la última llamada; lo resetea (message thread). */
+    float getAndResetPeakQueueFill();
+
     /** Estadísticas de agregación (thread-safe) */
     int getFusedHitsEnqueued() const;
     int getFusedHitsDiscardedQueue() const;
 
+    /** Eventos fusionados en un único trigger por coalescencia (viejos o fuera de presupuesto). Thread-safe. */
+    int getHitsCoalesced() const;
+
     /** M3: Número de bloques de audio en los que al menos un sample fue recortado (desde último reset). Thread-safe. */
     int getBlocksClippedCount() const;
 
+    /** Carga del audio thread por etapa (% del presupuesto del bloque) desde el snapshot anterior.
+     *  Message thread, un solo lector: MainComponent lo toma en timerCallback y lo reutiliza para /metrics. */
+    AudioLoadMonitor::Snapshot takeLoadSnapshot();
+
+    /** Sondas de latencia de los bloques ya renderizados (message thread, un solo lector). Devuelve cuántas copió. */
+    int popLatencyProbes(LatencyProbe* out, int maxCount);
+
+    /** Sondas perdidas con la cola llena o por exceso en un bloque. Thread-safe. */
+    int getLatencyProbesDropped() const;
+
     /** Resetea el motor completamente */
     void reset();
 
 private:
     //==============================================================================
-    static constexpr int MAX_HITS_PER_BLOCK = 32; // Límite de eventos procesados por bloque (aumentado para más eventos)
+    static constexpr int INITIAL_HITS_PER_BLOCK = 32; // Presupuesto hasta tener la primera medición de coste
+    static constexpr int MIN_HITS_PER_BLOCK = 8;  // Triggers individuales garantizados por bloque aunque el coste medido sea alto
+    static constexpr float DRAIN_BLOCK_FRACTION = 0.25f; // Fracción del tiempo de bloque dedicada a triggers individuales
+    static constexpr juce::uint32 STALE_EVENT_MS = 30; // Eventos más viejos que esto se coalescen en lugar de dispararse tarde
+    static constexpr int NUM_COALESCE_REGIONS = 4; // Cuadrante (fusionados) o banda de pitch 100-800 Hz (crudos)
     static constexpr int EVENT_QUEUE_SIZE = 128;  // Tamaño de la cola de eventos (aumentado para evitar descartes)
     static constexpr int FUSED_QUEUE_SIZE = 256; // Cola de eventos fusionados (hasta 4 por ventana 20 ms)
+    static constexpr int PROBE_QUEUE_SIZE = 512; // Sondas de latencia hacia el message thread (drenada cada 50 ms)
+    static constexpr int MAX_PROBES_PER_BLOCK = 32;
     
     VoiceManager voiceManager;
     PlateSynth plateSynth;
+    ResonatorBank resonatorBank;
     
     // Sample rate actual
     double currentSampleRate = 44100.0;
     
     // Parámetros globales (atomic para thread safety)
     std::atomic<int> maxVoices{8}; // Reducido a 8 por defecto para estabilidad RT
+    std::atomic<int> voicePoolSize{VoiceManager::DEFAULT_POOL_SIZE}; // Pool del próximo prepare
     std::atomic<float> metalness{0.5f};
     std::atomic<float> brightness{0.5f}; // Brightness global (0.0 = oscuro, 1.0 = brillante)
     std::atomic<float> damping{0.5f}; // Damping global (0.0 = corto, 1.0 = largo)
@@ -122,7 +196,12 @@ private:
     std::atomic<float> subOscMix{0.0f};
     std::atomic<float> pitchRange{0.5f}; // Rango de variación de pitch random (0.0-1.0)
     std::atomic<bool> limiterEnabled{true};
+    std::atomic<bool> limiterLookAhead{false};
     std::atomic<float> plateVolume{1.0f}; // Volumen del módulo Plate (0.0-1.0)
+    std::atomic<bool> voiceLaneRendering{true}; // Sincronizado al VoiceManager en cada bloque
+    std::atomic<float> voiceSilenceFloorDb{VoiceManager::DEFAULT_SILENCE_FLOOR_DB};
+    std::atomic<int> voiceSilenceHoldBlocks{VoiceManager::DEFAULT_SILENCE_HOLD_BLOCKS};
+    std::atomic<bool> resonatorBankMode{false}; // Leído al disparar: las colas de ambos motores conviven al cambiar
     
     // Parámetros de trigger manual
     std::atomic<float> testFreq{220.0f};
@@ -139,18 +218,49 @@ private:
     std::atomic<int> fusedHitsEnqueued{0};
     std::atomic<int> fusedHitsDiscardedQueue{0};
     
-    // Clipper (soft clip por sample, sin envelope follower)
+    // Clipper (recorte por sample, sin envelope follower) o limiter look-ahead al mismo techo
     float clipperThreshold = 0.95f;
+    LookAheadLimiter lookAheadLimiter;
+    bool lookAheadWasActive = false; // Audio thread: al activarlo se vacían sus delay lines
     std::atomic<int> blocksClippedCount{0}; // M3: bloques en los que hubo al menos un sample recortado
+    AudioLoadMonitor loadMonitor;           // Tiempo por etapa de cada renderNextBlock
+    
+    // Sondas de latencia: se acumulan durante el bloque y se publican al cerrarlo (con su carga)
+    juce::AbstractFifo probeFifo{PROBE_QUEUE_SIZE};
+    LatencyProbe probeQueue[PROBE_QUEUE_SIZE];
+    LatencyProbe blockProbes[MAX_PROBES_PER_BLOCK];
+    int numBlockProbes = 0;
+    juce::int64 blockCallbackNs = 0;        // steady_clock al entrar en renderNextBlock
+    juce::int64 samplePosition = 0;         // Samples renderizados desde prepare (posición del bloque actual)
+    std::atomic<int> latencyProbesDropped{0};
     
     // Medición de nivel de salida
     float outputLevel = 0.0f;
     float outputLevelDecay = 0.999f; // Decay para RMS
+    std::vector<float> meterWeights; // decay^k para la EMA por bloque (dimensionado en prepare)
     
     // Contadores de hits (thread-safe usando atomic)
     std::atomic<int> hitsReceived{0};
     std::atomic<int> hitsTriggered{0};
     std::atomic<int> hitsDiscarded{0};
+    std::atomic<int> hitsCoalesced{0};
+    std::atomic<int> peakQueueFillPermille{0}; // Pico de ocupación (0..1000) para feedback /load
+    
+    // Drenado adaptativo: coste medido por trigger (EMA en ticks de alta resolución)
+    double ticksPerSecond = 1.0;
+    double triggerCostTicks = 0.0; // 0 = sin medición todavía
+    
+    /** Acumulador de coalescencia por región (energía sumada, parámetros del evento más fuerte) */
+    struct CoalesceBucket
+    {
+        int count = 0;
+        float sumE = 0.0f;
+        float peakAmplitude = 0.0f;
+        juce::int64 probeSendNs = 0;    // Sonda más antigua entre los eventos coalescidos
+        FusedHitSnapshot peak;
+    };
+    CoalesceBucket fusedBuckets[NUM_COALESCE_REGIONS];
+    CoalesceBucket rawBuckets[NUM_COALESCE_REGIONS];
     
     // Buffer temporal para plate (RT-safe: pre-allocado, tamaño máximo)
     static constexpr int MAX_BLOCK_SIZE = 2048; // Tamaño máximo de bloque esperado
@@ -160,16 +270,33 @@ private:
     float prevMetalness = 0.5f;
     float prevBrightness = 0.5f;
     float prevDamping = 0.5f;
-    int parameterUpdateCounter = 0; // Contador para actualizar periódicamente
-    static constexpr int PARAMETER_UPDATE_INTERVAL = 4; // Actualizar cada 4 bloques (~10ms a 44.1kHz/512)
     
     //==============================================================================
-    /** Procesa eventos de la cola lock-free (llamado desde audio thread) */
-    void processEventQueue();
+    /** Procesa eventos de la cola lock-free (llamado desde audio thread).
+     *  Drena toda la cola: dispara individualmente hasta el presupuesto del bloque y coalesce el resto. */
+    void processEventQueue(int numSamples);
+
+    /** Número de triggers individuales que caben en el presupuesto de tiempo del bloque */
+    int computeDrainBudget(int numSamples) const;
+
+    /** Acumula un evento en el bucket de su región */
+    void coalesceEvent(CoalesceBucket& bucket, const FusedHitSnapshot& event);
+
+    /** Dispara un trigger por bucket no vacío y los vacía */
+    void flushCoalesceBuckets(CoalesceBucket* buckets, bool usePan);
+
+    /** Trigger de un evento (pan constant-power opcional); registra su sonda de latencia si la lleva */
+    void triggerSnapshot(const FusedHitSnapshot& s, bool usePan, bool coalesced = false);
+
+    /** Publica las sondas del bloque con su carga y latencia interna (fin de renderNextBlock) */
+    void publishLatencyProbes(float blockLoad, int latencySamples, int numSamples);
 
-    /** Aplica clipper (soft clip por sample) */
-    float applyClipper(float sample);
+    /** Master bus de un canal en una pasada: voces × voiceGain + plate × plateGain, recorte a
+     *  ±clipLevel, Σ x²·weights[i] en weightedSumSquares. Devuelve el pico pre-clipper. */
+    float processMasterChannel(float* data, const float* plateData, int numSamples,
+                               float voiceGain, float plateGain, float clipLevel,
+                               const float* weights, float& weightedSumSquares);
 
-    /** Actualiza el nivel de salida */
-    void updateOutputLevel(float sample);
+    /** Recalcula los pesos del medidor para outputLevelDecay (fuera del audio thread) */
+    void updateMeterWeights();
 };
@@ -1,62 +1,171 @@
 #include "VoiceManager.h"
+#include <algorithm>
 
 //==============================================================================
-VoiceManager::VoiceManager()
+/** Hilo auxiliar de render de voces: scratch de lanes y de mezcla propios (pre-allocados) */
+struct VoiceManager::RenderWorker : public juce::Thread
 {
-    maxVoices = DEFAULT_MAX_VOICES;
+    RenderWorker(VoiceManager& ownerToUse, int workerIndex)
+        : juce::Thread("Voice render " + juce::String(workerIndex)),
+          owner(ownerToUse), index(workerIndex)
+    {
+        left.resize((size_t)WORKER_SCRATCH_SAMPLES);
+        right.resize((size_t)WORKER_SCRATCH_SAMPLES);
+    }
+    
+    ~RenderWorker() override
+    {
+        stopThread(1000);
+    }
     
-    // RT-SAFE: Inicializar array de tiempos de trigger y pan
-    for (int i = 0; i < MAX_VOICES_LIMIT; i++)
+    void run() override
     {
-        voiceTriggerTime[i] = -1;
-        voiceGainL[i] = 1.0f;
-        voiceGainR[i] = 1.0f;
+        // FTZ/DAZ es por hilo: el worker no hereda el del audio thread
+        juce::ScopedNoDenormals noDenormals;
+        double lastWorkMs = 0.0;
+        juce::uint32 seenGeneration = 0;
+        while (!threadShouldExit())
+        {
+            // Deshabilitado: bloqueado hasta setRenderWorkers/stopThread (notify desde message thread)
+            if (index >= owner.enabledRenderWorkers.load(std::memory_order_relaxed))
+            {
+                wait(-1);
+                continue;
+            }
+            
+            auto generation = (juce::uint32)(owner.jobState.load(std::memory_order_acquire) >> 32);
+            if (generation != seenGeneration)
+            {
+                seenGeneration = generation;
+                while (owner.runRenderJob(generation, group, left.data(), right.data(), this))
+                    lastWorkMs = juce::Time::getMillisecondCounterHiRes();
+                continue;
+            }
+            
+            // Sin trabajo: spin una fracción del bloque (render offline: el siguiente llega enseguida) y luego
+            // dormir. sleeping antes de volver a mirar la generación: el audio thread publica y luego lo lee
+            // para despertar con notify(), así ninguno de los dos se pierde el bloque nuevo.
+            if (juce::Time::getMillisecondCounterHiRes() - lastWorkMs < spinMs)
+            {
+                juce::Thread::yield();
+                continue;
+            }
+            sleeping.store(true);
+            if ((juce::uint32)(owner.jobState.load() >> 32) == seenGeneration)
+                wait(-1);
+            sleeping.store(false);
+        }
     }
+    
+    VoiceManager& owner;
+    const int index;
+    VoiceLaneGroup group;
+    std::vector<float> left, right;
+    juce::uint32 mixedGeneration = 0; // Generación cuya mezcla está en left/right (solo este hilo)
+    double spinMs = 0.0;              // WORKER_SPIN_FRACTION del último bloque renderizado
+    std::atomic<bool> sleeping{false};
+};
+
+//==============================================================================
+VoiceManager::VoiceManager()
+{
+    maxVoices = DEFAULT_MAX_VOICES;
+    for (auto& claim : jobClaims)
+        claim.store(0, std::memory_order_relaxed);
+}
+
+VoiceManager::~VoiceManager()
+{
+    // Parar los workers antes de destruir las voces que renderizan
+    for (auto& worker : renderWorkers)
+        worker.reset();
 }
 
 //==============================================================================
-void VoiceManager::prepare(double sampleRate, int maxVoicesToSet)
+void VoiceManager::prepare(double sampleRate, int maxVoicesToSet, int poolSizeToSet)
 {
+    // Un worker atrasado aún puede estar renderizando voces del pool anterior
+    drainLateRenderWorkers();
+    
     currentSampleRate = sampleRate;
+    poolSize = juce::jlimit(MIN_VOICES_LIMIT, MAX_POOL_SIZE, poolSizeToSet);
+    preparedPoolSize.store(poolSize);
     
-    // RT-SAFE: Pre-allocar todas las voces hasta MAX_VOICES_LIMIT (una sola vez)
-    while (voices.size() < MAX_VOICES_LIMIT)
+    // RT-SAFE: Pre-allocar todas las voces del pool (una sola vez; aquí no es audio thread)
+    while (voices.size() < poolSize)
     {
-        auto* voice = new ModalVoice();
-        voice->prepare(sampleRate);
-        voices.add(voice);
+        voices.add(new ModalVoice());
     }
     
-    // Establecer límite activo (no modifica el array, solo el contador)
-    maxVoices = juce::jlimit(MIN_VOICES_LIMIT, MAX_VOICES_LIMIT, maxVoicesToSet);
-    
-    // Preparar todas las voces pre-allocadas
-    for (auto* voice : voices)
+    excitationTables.prepare(sampleRate);
+    for (int i = 0; i < poolSize; i++)
     {
-        voice->prepare(sampleRate);
+        voices.getUnchecked(i)->setExcitationTables(&excitationTables);
+        voices.getUnchecked(i)->prepare(sampleRate);
     }
     
-    // Resetear tiempos de trigger
-    for (int i = 0; i < MAX_VOICES_LIMIT; i++)
+    // Estado por voz y estructuras de asignación dimensionadas al pool (capacidad fija)
+    voiceTriggerTime.assign((size_t)poolSize, -1);
+    voiceGainL.assign((size_t)poolSize, 1.0f);
+    voiceGainR.assign((size_t)poolSize, 1.0f);
+    voiceRegion.assign((size_t)poolSize, -1);
+    voicePriority.assign((size_t)poolSize, 0.0f);
+    activeVoices.clear();
+    activeVoices.reserve((size_t)poolSize);
+    activeSlot.assign((size_t)poolSize, -1);
+    jobVoices.assign((size_t)poolSize, 0);
+    voiceParamsVersion.assign((size_t)poolSize, globalParamsVersion);
+    for (auto& region : regions)
     {
-        voiceTriggerTime[i] = -1;
+        region.freeList.clear();
+        region.freeList.reserve((size_t)poolSize);
+        region.stealHeap.clear();
+        region.stealHeap.reserve((size_t)poolSize);
     }
     
+    // Establecer límite activo (no modifica el pool, solo el contador)
+    maxVoices = juce::jlimit(MIN_VOICES_LIMIT, poolSize, maxVoicesToSet);
+    requestedMaxVoices.store(maxVoices);
+    maxVoicesPerQuadrant = requestedVoicesPerQuadrant.load();
+    
     currentTime = 0;
+    rebuildRegions();
+}
+
+//==============================================================================
+void VoiceManager::setRenderWorkers(int numWorkers, bool waitForWorkers)
+{
+    const int maxWorkers = juce::jmax(0, juce::jmin(MAX_RENDER_WORKERS, juce::SystemStats::getNumCpus() - 1));
+    numWorkers = juce::jlimit(0, maxWorkers, numWorkers);
+    waitForRenderWorkers.store(waitForWorkers);
+    
+    // Hilos bajo demanda (una sola vez cada uno; aquí no es audio thread): sin render multihilo no hay hilos.
+    // Prioridad realtime como el audio thread: un worker desalojado retrasa el bloque.
+    // Sin permiso de realtime (p. ej. Linux sin rtprio) queda en la prioridad más alta normal.
+    for (int i = startedRenderWorkers.load(); i < numWorkers; i++)
+    {
+        renderWorkers[i] = std::make_unique<RenderWorker>(*this, i);
+        if (!renderWorkers[i]->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10)))
+            renderWorkers[i]->startThread(juce::Thread::Priority::highest);
+        startedRenderWorkers.store(i + 1, std::memory_order_release);
+    }
+    
+    // Arrancan bloqueados: el notify los despierta para que vean el nuevo número
+    enabledRenderWorkers.store(numWorkers);
+    for (int i = 0; i < startedRenderWorkers.load(); i++)
+        renderWorkers[i]->notify();
 }
 
 //==============================================================================
 void VoiceManager::setMaxVoices(int newMaxVoices)
 {
-    newMaxVoices = juce::jlimit(MIN_VOICES_LIMIT, MAX_VOICES_LIMIT, newMaxVoices);
-    if (newMaxVoices == maxVoices)
-        return;
-    maxVoices = newMaxVoices;
+    // Se aplica en el audio thread (applyPendingLayout): free lists y heaps no se tocan desde UI
+    requestedMaxVoices.store(juce::jlimit(MIN_VOICES_LIMIT, getPoolSize(), newMaxVoices));
 }
 
 void VoiceManager::setMaxVoicesPerQuadrant(int n)
 {
-    maxVoicesPerQuadrant = juce::jlimit(0, 8, n);
+    requestedVoicesPerQuadrant.store(juce::jlimit(0, 8, n));
 }
 
 //==============================================================================
@@ -67,39 +176,33 @@ void VoiceManager::triggerVoice(float baseFreq, float amplitude, float damping,
                                  float gainL, float gainR,
                                  int quadrant)
 {
-    if (maxVoices == 0 || voices.size() == 0)
+    applyPendingLayout();
+    if (maxVoices == 0 || poolSize == 0)
         return;
     
-    ModalVoice* voiceToUse = findAvailableVoice(quadrant);
-    if (voiceToUse == nullptr)
-        voiceToUse = findVoiceToSteal(quadrant);
+    // RT-SAFE: O(1) desde free list; si no hay libres, robo O(log n) desde heap
+    int voiceIndex = findAvailableVoice(quadrant);
+    if (voiceIndex < 0)
+        voiceIndex = findVoiceToSteal(quadrant);
+    if (voiceIndex < 0)
+        return;
     
-    if (voiceToUse != nullptr)
-    {
-        // RT-SAFE: Calcular índice directamente (voces están en array fijo)
-        // En lugar de indexOf() que es costoso, calculamos el índice desde el puntero
-        int voiceIndex = -1;
-        int searchLimit = juce::jmin(maxVoices, voices.size());
-        for (int i = 0; i < searchLimit; i++)
-        {
-            if (voices.getUnchecked(i) == voiceToUse)
-            {
-                voiceIndex = i;
-                break;
-            }
-        }
-        
-        // Configurar y trigger la voz
-        voiceToUse->setParameters(baseFreq, amplitude, damping, brightness, metalness, waveform, subOscMix);
-        voiceToUse->trigger();
-        
-        if (voiceIndex >= 0)
-        {
-            updateVoiceTime(voiceIndex);
-            voiceGainL[voiceIndex] = gainL;
-            voiceGainR[voiceIndex] = gainR;
-        }
-    }
+    // Configurar y trigger la voz
+    auto* voiceToUse = voices.getUnchecked(voiceIndex);
+    voiceToUse->setParameters(baseFreq, amplitude, damping, brightness, metalness, waveform, subOscMix);
+    voiceToUse->trigger();
+    
+    updateVoiceTime(voiceIndex);
+    voiceGainL[(size_t)voiceIndex] = gainL;
+    voiceGainR[(size_t)voiceIndex] = gainR;
+    voiceParamsVersion[(size_t)voiceIndex] = globalParamsVersion; // Usa los parámetros del evento
+    addActiveVoice(voiceIndex);
+    
+    // Entrar al heap de su región con la amplitud inicial como clave de robo
+    voicePriority[(size_t)voiceIndex] = voiceToUse->getResidualAmplitude();
+    auto& heap = regions[voiceRegion[(size_t)voiceIndex]].stealHeap;
+    heap.push_back(voiceIndex);
+    std::push_heap(heap.begin(), heap.end(), [this](int a, int b) { return stealsAfter(a, b); });
 }
 
 //==============================================================================
@@ -108,191 +211,874 @@ void VoiceManager::renderNextBlock(juce::AudioBuffer<float>& buffer, int startSa
     // Limpiar el buffer primero
     buffer.clear(startSample, numSamples);
     
-    // RT-SAFE: Verificar que hay voces disponibles
-    if (maxVoices == 0 || voices.size() == 0)
-        return;
-    
     // Obtener write pointers una sola vez
     float* leftChannel = buffer.getWritePointer(0, startSample);
     float* rightChannel = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1, startSample) : nullptr;
     
-    // RT-SAFE: Renderizar solo voces dentro del rango activo (maxVoices)
-    int searchLimit = juce::jmin(maxVoices, voices.size());
-    for (int i = 0; i < searchLimit; i++)
+    // Workers atrasados en un bloque anterior: si ya terminaron, su mezcla entra en este bloque
+    if (lateRenderWorkers != 0)
+        mixLateRenderWorkers(leftChannel, rightChannel, numSamples);
+    
+    // RT-SAFE: Verificar que hay voces disponibles
+    applyPendingLayout();
+    if (maxVoices == 0 || poolSize == 0)
+        return;
+    
+    applyGlobalParameterUpdates();
+    
+    // RT-SAFE: Renderizar solo las voces de la lista activa (las idle no se visitan).
+    // Con un worker atrasado no se publica otro bloque: su scratch y sus jobs siguen siendo suyos.
+    const int numActive = (int)activeVoices.size();
+    const int numWorkers = juce::jmin(enabledRenderWorkers.load(std::memory_order_relaxed),
+                                      startedRenderWorkers.load(std::memory_order_acquire));
+    
+    if (numWorkers > 0 && lateRenderWorkers == 0 && numActive > VOICE_LANES && numSamples <= WORKER_SCRATCH_SAMPLES)
+    {
+        renderVoicesParallel(leftChannel, rightChannel, numSamples, numWorkers);
+    }
+    else if (voiceLaneRendering)
     {
+        // Lanes empaquetadas desde la lista: grupos llenos aunque las voces activas estén dispersas en el pool
+        for (int first = 0; first < numActive; first += VOICE_LANES)
+            renderVoiceGroup(laneGroup, activeVoices.data() + first, juce::jmin(VOICE_LANES, numActive - first),
+                             leftChannel, rightChannel, numSamples);
+    }
+    else
+    {
+        renderVoicesSerial(activeVoices.data(), numActive, leftChannel, rightChannel, numSamples);
+    }
+    
+    updateActiveVoices();
+    if (lateRenderWorkers != 0)
+        reattachLateRenderWorkers();
+    refreshStealHeaps();
+    
+    // Incrementar tiempo global
+    currentTime += numSamples;
+}
+
+//==============================================================================
+void VoiceManager::renderVoicesSerial(const int* voiceIndices, int numVoices, float* leftChannel, float* rightChannel, int numSamples)
+{
+    for (int k = 0; k < numVoices; k++)
+    {
+        int i = voiceIndices[k];
         auto* voice = voices.getUnchecked(i);
         
-        // Check rápido de actividad antes del loop
-        if (!voice->isActive())
-            continue;
-        
         // Stereo mix: constant-power pan (gL = sqrt(0.5*(1-pan)), gR = sqrt(0.5*(1+pan))) per voice
         float gL = voiceGainL[i];
         float gR = voiceGainR[i];
-        for (int sample = 0; sample < numSamples; sample++)
+        
+        // Render por bloque (banco de modos SIMD) en segmentos de scratch fijo en stack
+        float voiceBlock[RENDER_SCRATCH_SAMPLES];
+        for (int offset = 0; offset < numSamples; offset += RENDER_SCRATCH_SAMPLES)
         {
-            float sampleValue = voice->renderNextSample();
-            leftChannel[sample] += sampleValue * gL;
+            int len = juce::jmin(RENDER_SCRATCH_SAMPLES, numSamples - offset);
+            voice->renderBlock(voiceBlock, len);
+            juce::FloatVectorOperations::addWithMultiply(leftChannel + offset, voiceBlock, gL, len);
             if (rightChannel != nullptr)
-                rightChannel[sample] += sampleValue * gR;
+                juce::FloatVectorOperations::addWithMultiply(rightChannel + offset, voiceBlock, gR, len);
         }
     }
-    
-    // Incrementar tiempo global
-    currentTime += numSamples;
 }
 
 //==============================================================================
-int VoiceManager::getActiveVoiceCount() const
+void VoiceManager::renderVoicesParallel(float* left, float* right, int numSamples, int numWorkers)
 {
-    // RT-SAFE: Contar solo dentro del rango activo
-    if (maxVoices == 0 || voices.size() == 0)
-        return 0;
+    // Publicar el bloque: lista de voces copiada (la activa cambia tras el bloque y un worker atrasado aún
+    // la lee), parámetros, claims abiertos y por último jobState con la nueva generación
+    const int numActive = (int)activeVoices.size();
+    const int numJobs = (numActive + VOICE_LANES - 1) / VOICE_LANES;
+    std::copy(activeVoices.begin(), activeVoices.end(), jobVoices.begin());
+    jobVoiceCount = numActive;
+    jobCount = numJobs;
+    jobNumSamples = numSamples;
+    jobStereo = right != nullptr;
+    jobsCompleted.store(0, std::memory_order_relaxed);
+    jobGeneration = jobGeneration + 1 == 0 ? 1 : jobGeneration + 1; // 0 = "ninguna" en los workers
+    for (int job = 0; job < numJobs; job++)
+        jobClaims[job].store((juce::uint64)jobGeneration << 8, std::memory_order_relaxed);
+    jobState.store(((juce::uint64)jobGeneration << 32) | ((juce::uint64)numJobs << 16));
     
-    int count = 0;
-    int searchLimit = juce::jmin(maxVoices, voices.size());
-    for (int i = 0; i < searchLimit; i++)
+    // Despertar a los workers que se durmieron (sin lock si están en spin; ver RenderWorker::run)
+    for (int w = 0; w < numWorkers; w++)
     {
-        if (voices.getUnchecked(i)->isActive())
-            count++;
+        if (renderWorkers[w]->sleeping.exchange(false))
+            renderWorkers[w]->notify();
+    }
+    
+    // El audio thread también toma jobs (mezcla directa): un worker dormido solo resta paralelismo
+    while (runRenderJob(jobGeneration, laneGroup, left, right, nullptr)) {}
+    
+    // Esperar (spin acotado) los jobs que los workers ya reclamaron: como mucho un grupo por worker
+    const juce::int64 waitTicks = (juce::int64)(WORKER_WAIT_US * 1.0e-6 * (double)juce::Time::getHighResolutionTicksPerSecond());
+    const juce::int64 waitStart = juce::Time::getHighResolutionTicks();
+    while (jobsCompleted.load(std::memory_order_acquire) < numJobs)
+    {
+        if (juce::Time::getHighResolutionTicks() - waitStart > waitTicks)
+            break;
+    }
+    
+    if (jobsCompleted.load(std::memory_order_acquire) < numJobs)
+    {
+        // Worker atrasado (desalojado): renderizar aquí los jobs reclamados que aún nadie empezó
+        for (int job = 0; job < numJobs; job++)
+        {
+            if (claimRenderJob(job, jobGeneration, JOB_AUDIO_THREAD))
+                renderJob(job, laneGroup, left, right);
+        }
+        
+        // Render offline: sin plazo, esperar los jobs a medio renderizar
+        if (waitForRenderWorkers.load(std::memory_order_relaxed))
+        {
+            while (jobsCompleted.load(std::memory_order_acquire) < numJobs)
+                juce::Thread::yield();
+        }
+    }
+    
+    // Ya no quedan jobs abiertos: un worker con uno sin terminar queda atrasado. Sus voces (no se pueden
+    // rehacer ni tocar mientras las renderiza) salen de la lista; su mezcla entra en el primer bloque en que
+    // haya terminado y vuelven después de ese bloque: esas voces siguen continuas, desplazadas en el tiempo.
+    int participants = 0;
+    lateRenderWorkers = scanRenderJobs(participants);
+    if (lateRenderWorkers != 0)
+    {
+        renderWorkerStalls.fetch_add(1, std::memory_order_relaxed);
+        for (int job = 0; job < numJobs; job++)
+        {
+            auto claimant = jobClaims[job].load(std::memory_order_relaxed) & JOB_CLAIMANT_MASK;
+            if (claimant >= JOB_WORKER && (lateRenderWorkers >> (claimant - JOB_WORKER)) & 1)
+                detachRenderJobVoices(job);
+        }
+        for (int w = 0; w < MAX_RENDER_WORKERS; w++)
+            lateMixOffset[w] = (lateRenderWorkers >> w & 1) != 0 ? -1 : 0;
+    }
+    
+    // Sumar los scratch de los workers que terminaron todos sus jobs de este bloque
+    for (int w = 0; w < MAX_RENDER_WORKERS; w++)
+    {
+        if (((participants & ~lateRenderWorkers) >> w & 1) == 0)
+            continue;
+        juce::FloatVectorOperations::add(left, renderWorkers[w]->left.data(), numSamples);
+        if (right != nullptr)
+            juce::FloatVectorOperations::add(right, renderWorkers[w]->right.data(), numSamples);
     }
-    return count;
 }
 
-//==============================================================================
-void VoiceManager::resetAll()
+int VoiceManager::scanRenderJobs(int& participants) const
+{
+    // acquire sobre JOB_DONE: el scratch de un worker con todos sus jobs terminados es legible
+    int unfinished = 0;
+    participants = 0;
+    for (int job = 0; job < jobCount; job++)
+    {
+        auto claim = jobClaims[job].load(std::memory_order_acquire);
+        auto claimant = claim & JOB_CLAIMANT_MASK;
+        if (claimant < JOB_WORKER)
+            continue;
+        participants |= 1 << (claimant - JOB_WORKER);
+        if ((claim & JOB_DONE) == 0)
+            unfinished |= 1 << (claimant - JOB_WORKER);
+    }
+    return unfinished;
+}
+
+void VoiceManager::detachRenderJobVoices(int job)
+{
+    // Fuera de la lista activa (render, parámetros, fin de bloque) y del heap (robo); no está en free lists.
+    // El heap se reordena en refreshStealHeaps al final de este bloque.
+    const int first = job * VOICE_LANES;
+    const int count = juce::jmin(VOICE_LANES, jobVoiceCount - first);
+    for (int k = 0; k < count; k++)
+    {
+        int index = jobVoices[(size_t)(first + k)];
+        removeActiveVoice(index);
+        auto& heap = regions[voiceRegion[(size_t)index]].stealHeap;
+        auto it = std::find(heap.begin(), heap.end(), index);
+        if (it != heap.end())
+        {
+            *it = heap.back();
+            heap.pop_back();
+        }
+    }
+}
+
+void VoiceManager::reattachRenderJobVoices(int job)
+{
+    // El bloque atrasado cierra su nivel como cualquier otro (fin temprano incluido)
+    const int first = job * VOICE_LANES;
+    const int count = juce::jmin(VOICE_LANES, jobVoiceCount - first);
+    for (int k = 0; k < count; k++)
+    {
+        int index = jobVoices[(size_t)(first + k)];
+        auto* voice = voices.getUnchecked(index);
+        auto& region = regions[voiceRegion[(size_t)index]];
+        if (voice->finishBlock(silenceFloorGain, silenceHoldBlocks))
+        {
+            addActiveVoice(index);
+            voicePriority[(size_t)index] = voice->getResidualAmplitude();
+            region.stealHeap.push_back(index);
+            std::push_heap(region.stealHeap.begin(), region.stealHeap.end(), [this](int a, int b) { return stealsAfter(a, b); });
+            if (voiceParamsVersion[(size_t)index] != globalParamsVersion)
+                globalParamsPending = true;
+        }
+        else
+        {
+            region.freeList.push_back(index);
+        }
+    }
+}
+
+void VoiceManager::mixLateRenderWorkers(float* left, float* right, int numSamples)
+{
+    // left == nullptr: descartar (drain). Si este bloque es más corto que el atrasado, el resto en el siguiente.
+    int participants = 0;
+    const int unfinished = scanRenderJobs(participants);
+    for (int w = 0; w < MAX_RENDER_WORKERS; w++)
+    {
+        if ((lateRenderWorkers >> w & 1) == 0 || (lateMixOffset[w] < 0 && (unfinished >> w & 1) != 0))
+            continue;
+        lateMixOffset[w] = juce::jmax(0, lateMixOffset[w]);
+        const int len = left != nullptr ? juce::jmin(numSamples, jobNumSamples - lateMixOffset[w]) : jobNumSamples - lateMixOffset[w];
+        if (left != nullptr && len > 0)
+        {
+            juce::FloatVectorOperations::add(left, renderWorkers[w]->left.data() + lateMixOffset[w], len);
+            if (right != nullptr && jobStereo)
+                juce::FloatVectorOperations::add(right, renderWorkers[w]->right.data() + lateMixOffset[w], len);
+        }
+        lateMixOffset[w] += len;
+    }
+}
+
+void VoiceManager::reattachLateRenderWorkers()
 {
-    // RT-SAFE: Resetear solo voces dentro del rango activo
-    if (voices.size() > 0)
+    // Tras el render: las voces no sonaron en este bloque (su bloque atrasado sí), así siguen sin solaparse
+    for (int w = 0; w < MAX_RENDER_WORKERS; w++)
     {
-        int resetLimit = juce::jmin(maxVoices, voices.size());
-        for (int i = 0; i < resetLimit; i++)
+        if ((lateRenderWorkers >> w & 1) == 0 || lateMixOffset[w] < jobNumSamples)
+            continue;
+        for (int job = 0; job < jobCount; job++)
         {
-            voices.getUnchecked(i)->reset();
+            auto claimant = jobClaims[job].load(std::memory_order_relaxed) & JOB_CLAIMANT_MASK;
+            if (claimant == JOB_WORKER + (juce::uint64)w)
+                reattachRenderJobVoices(job);
         }
+        lateRenderWorkers &= ~(1 << w);
+    }
+}
+
+void VoiceManager::drainLateRenderWorkers()
+{
+    while (lateRenderWorkers != 0)
+    {
+        mixLateRenderWorkers(nullptr, nullptr, 0);
+        reattachLateRenderWorkers();
+        if (lateRenderWorkers != 0)
+            juce::Thread::yield();
+    }
+}
+
+//==============================================================================
+bool VoiceManager::runRenderJob(juce::uint32 generation, VoiceLaneGroup& g, float* left, float* right, RenderWorker* worker)
+{
+    // Reclamar el próximo job por CAS sobre (generación | nº jobs | próximo)
+    auto state = jobState.load(std::memory_order_acquire);
+    int job = 0;
+    for (;;)
+    {
+        if ((juce::uint32)(state >> 32) != generation)
+            return false;
+        int numJobs = (int)((state >> 16) & 0xFFFF);
+        job = (int)(state & 0xFFFF);
+        if (job >= numJobs)
+            return false;
+        if (jobState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            break;
     }
     
-    // Resetear tiempos de trigger y pan
-    for (int i = 0; i < MAX_VOICES_LIMIT; i++)
+    // Índice obtenido; si el audio thread ya lo robó, pasar al siguiente
+    if (!claimRenderJob(job, generation, worker != nullptr ? JOB_WORKER + (juce::uint64)worker->index : JOB_AUDIO_THREAD))
+        return true;
+    
+    // Job tomado: la generación no avanza hasta que se complete, los parámetros del bloque son estables
+    const int numSamples = jobNumSamples;
+    if (worker != nullptr)
     {
-        voiceTriggerTime[i] = -1;
-        voiceGainL[i] = 1.0f;
-        voiceGainR[i] = 1.0f;
+        worker->spinMs = WORKER_SPIN_FRACTION * 1000.0 * (double)numSamples / currentSampleRate;
+        if (!jobStereo)
+            right = nullptr;
+        if (worker->mixedGeneration != generation)
+        {
+            juce::FloatVectorOperations::clear(left, numSamples);
+            if (right != nullptr)
+                juce::FloatVectorOperations::clear(right, numSamples);
+            worker->mixedGeneration = generation;
+        }
     }
     
-    currentTime = 0;
+    renderJob(job, g, left, right);
+    return true;
+}
+
+bool VoiceManager::claimRenderJob(int job, juce::uint32 generation, juce::uint64 claimant)
+{
+    auto open = (juce::uint64)generation << 8;
+    return jobClaims[job].compare_exchange_strong(open, open | claimant, std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+void VoiceManager::renderJob(int job, VoiceLaneGroup& g, float* left, float* right)
+{
+    const int first = job * VOICE_LANES;
+    const int count = juce::jmin(VOICE_LANES, jobVoiceCount - first);
+    if (voiceLaneRendering)
+        renderVoiceGroup(g, jobVoices.data() + first, count, left, right, jobNumSamples);
+    else
+        renderVoicesSerial(jobVoices.data() + first, count, left, right, jobNumSamples);
+    
+    jobClaims[job].fetch_or(JOB_DONE, std::memory_order_release);
+    jobsCompleted.fetch_add(1, std::memory_order_release);
 }
 
 //==============================================================================
-ModalVoice* VoiceManager::findAvailableVoice(int quadrant)
+void VoiceManager::renderVoiceGroup(VoiceLaneGroup& g, const int* voiceIndices, int numLanes, float* left, float* right, int numSamples)
 {
-    if (maxVoices == 0 || voices.size() == 0)
-        return nullptr;
+    bool laneUsed[VOICE_LANES];
+    bool anyUsed = false;
+    bool anyRamp = false;
     
-    int searchLimit = juce::jmin(maxVoices, (int)voices.size());
-    int reservedTotal = 4 * maxVoicesPerQuadrant;
+    // Gather: coeficientes y estados de cada ModeBank a su lane; lanes vacías enmascaradas (coef 0)
+    for (int l = 0; l < VOICE_LANES; l++)
+    {
+        laneUsed[l] = l < numLanes && voices.getUnchecked(voiceIndices[l])->isActive();
+        anyUsed = anyUsed || laneUsed[l];
+        if (!laneUsed[l])
+        {
+            for (int m = 0; m < NUM_MODES; m++)
+                g.b0[m][l] = g.b2[m][l] = g.a1[m][l] = g.a2[m][l] = g.y1[m][l] = g.y2[m][l] = 0.0f;
+            g.x1[l] = g.x2[l] = 0.0f;
+            g.fb0[l] = 1.0f;
+            g.fb1[l] = g.fb2[l] = g.fa1[l] = g.fa2[l] = 0.0f;
+            g.fx1[l] = g.fx2[l] = g.fy1[l] = g.fy2[l] = 0.0f;
+            g.rampChunks[l] = g.formantRampChunks[l] = 0;
+            continue;
+        }
+        auto& bank = voices.getUnchecked(voiceIndices[l])->getModeBank();
+        for (int m = 0; m < NUM_MODES; m++)
+        {
+            g.b0[m][l] = bank.b0[m];
+            g.b2[m][l] = bank.b2[m];
+            g.a1[m][l] = bank.a1[m];
+            g.a2[m][l] = bank.a2[m];
+            g.y1[m][l] = bank.y1[m];
+            g.y2[m][l] = bank.y2[m];
+            g.db0[m][l] = bank.db0[m];
+            g.db2[m][l] = bank.db2[m];
+            g.da1[m][l] = bank.da1[m];
+            g.da2[m][l] = bank.da2[m];
+        }
+        g.x1[l] = bank.x1;
+        g.x2[l] = bank.x2;
+        g.rampChunks[l] = bank.rampChunks;
+        anyRamp = anyRamp || bank.rampChunks > 0;
+        
+        if (auto* formant = voices.getUnchecked(voiceIndices[l])->getFormantFilter())
+        {
+            g.fb0[l] = formant->b0; g.fb1[l] = formant->b1; g.fb2[l] = formant->b2;
+            g.fa1[l] = formant->a1; g.fa2[l] = formant->a2;
+            g.fx1[l] = formant->x1; g.fx2[l] = formant->x2;
+            g.fy1[l] = formant->y1; g.fy2[l] = formant->y2;
+            g.fdb0[l] = formant->db0; g.fdb1[l] = formant->db1; g.fdb2[l] = formant->db2;
+            g.fda1[l] = formant->da1; g.fda2[l] = formant->da2;
+            g.formantRampChunks[l] = formant->rampChunks;
+            anyRamp = anyRamp || formant->rampChunks > 0;
+        }
+        else
+        {
+            g.fb0[l] = 1.0f;
+            g.fb1[l] = g.fb2[l] = g.fa1[l] = g.fa2[l] = 0.0f;
+            g.fx1[l] = g.fx2[l] = g.fy1[l] = g.fy2[l] = 0.0f;
+            g.formantRampChunks[l] = 0;
+        }
+    }
+    if (!anyUsed)
+        return;
+    
+    // Buffers sample-major (8 lanes contiguas por sample) para el loop SIMD
+    alignas(32) float excitation[LANE_CHUNK][VOICE_LANES];
+    alignas(32) float modesOut[LANE_CHUNK][VOICE_LANES];
+    float laneBlock[LANE_CHUNK];
     
-    if (quadrant >= 0 && quadrant < 4 && reservedTotal <= maxVoices)
+    for (int pos = 0; pos < numSamples; pos += LANE_CHUNK)
     {
-        // Primero buscar en el presupuesto del cuadrante
-        int quadStart = quadrant * maxVoicesPerQuadrant;
-        int quadEnd = juce::jmin(quadStart + maxVoicesPerQuadrant, searchLimit);
-        for (int i = quadStart; i < quadEnd; i++)
+        const int len = juce::jmin(LANE_CHUNK, numSamples - pos);
+        
+        // Excitación por voz (solo mientras dura el burst), transpuesta a lanes
+        bool laneActive[VOICE_LANES];
+        bool anyActive = false;
+        bool anyExcitation = false;
+        for (int l = 0; l < VOICE_LANES; l++)
         {
-            auto* voice = voices.getUnchecked(i);
-            if (!voice->isActive())
-                return voice;
+            auto* voice = laneUsed[l] ? voices.getUnchecked(voiceIndices[l]) : nullptr;
+            laneActive[l] = voice != nullptr && voice->isActive();
+            anyActive = anyActive || laneActive[l];
+            bool excited = laneActive[l] && voice->renderExcitationBlock(laneBlock, len);
+            anyExcitation = anyExcitation || excited;
+            for (int i = 0; i < len; i++)
+                excitation[i][l] = excited ? laneBlock[i] : 0.0f;
         }
-        // Luego en el pool compartido
-        for (int i = reservedTotal; i < searchLimit; i++)
+        if (!anyActive)
+            break;
+        
+        // Rampas de coeficientes: un paso por segmento, como ModalVoice::renderBlock
+        if (anyRamp)
+            stepLaneRamps(g);
+        
+        bool historyZero = true;
+        for (int l = 0; l < VOICE_LANES; l++)
+            historyZero = historyZero && g.x1[l] == 0.0f && g.x2[l] == 0.0f;
+        
+        // Hot loop: loops internos de VOICE_LANES fijos, sin dependencias entre lanes (vectorizables)
+        if (!anyExcitation && historyZero)
         {
-            auto* voice = voices.getUnchecked(i);
-            if (!voice->isActive())
-                return voice;
+            // Ringing libre: solo la recursión de salida
+            for (int i = 0; i < len; i++)
+            {
+                float acc[VOICE_LANES] = {};
+                for (int m = 0; m < NUM_MODES; m++)
+                {
+                    for (int l = 0; l < VOICE_LANES; l++)
+                    {
+                        float y = -g.a1[m][l] * g.y1[m][l] - g.a2[m][l] * g.y2[m][l];
+                        g.y2[m][l] = g.y1[m][l];
+                        g.y1[m][l] = y;
+                        acc[l] += y;
+                    }
+                }
+                for (int l = 0; l < VOICE_LANES; l++)
+                    modesOut[i][l] = acc[l];
+            }
+        }
+        else
+        {
+            for (int i = 0; i < len; i++)
+            {
+                const float* x = excitation[i];
+                float acc[VOICE_LANES] = {};
+                for (int m = 0; m < NUM_MODES; m++)
+                {
+                    for (int l = 0; l < VOICE_LANES; l++)
+                    {
+                        float y = g.b0[m][l] * x[l] + g.b2[m][l] * g.x2[l]
+                                - g.a1[m][l] * g.y1[m][l] - g.a2[m][l] * g.y2[m][l];
+                        g.y2[m][l] = g.y1[m][l];
+                        g.y1[m][l] = y;
+                        acc[l] += y;
+                    }
+                }
+                for (int l = 0; l < VOICE_LANES; l++)
+                {
+                    g.x2[l] = g.x1[l];
+                    g.x1[l] = x[l];
+                    modesOut[i][l] = acc[l];
+                }
+            }
+        }
+        
+        // Formant en lanes (biquad serial por voz: es el recorrido crítico si se hace voz a voz)
+        for (int i = 0; i < len; i++)
+        {
+            float* s = modesOut[i];
+            for (int l = 0; l < VOICE_LANES; l++)
+            {
+                float y = g.fb0[l] * s[l] + g.fb1[l] * g.fx1[l] + g.fb2[l] * g.fx2[l]
+                        - g.fa1[l] * g.fy1[l] - g.fa2[l] * g.fy2[l];
+                g.fx2[l] = g.fx1[l];
+                g.fx1[l] = s[l];
+                g.fy2[l] = g.fy1[l];
+                g.fy1[l] = y;
+                s[l] = y;
+            }
+        }
+        
+        // Etapas por voz (ADSR, sub-osc) y mezcla con pan constant-power
+        for (int l = 0; l < VOICE_LANES; l++)
+        {
+            if (!laneActive[l])
+                continue;
+            for (int i = 0; i < len; i++)
+                laneBlock[i] = modesOut[i][l];
+            int voiceIndex = voiceIndices[l];
+            voices.getUnchecked(voiceIndex)->applyEnvelopeStages(laneBlock, len);
+            juce::FloatVectorOperations::addWithMultiply(left + pos, laneBlock, voiceGainL[voiceIndex], len);
+            if (right != nullptr)
+                juce::FloatVectorOperations::addWithMultiply(right + pos, laneBlock, voiceGainR[voiceIndex], len);
         }
-        return nullptr;
     }
     
-    for (int i = 0; i < searchLimit; i++)
+    // Scatter: devolver estados a las ModeBank de las voces
+    for (int l = 0; l < numLanes; l++)
     {
-        auto* voice = voices.getUnchecked(i);
-        if (!voice->isActive())
-            return voice;
+        if (!laneUsed[l])
+            continue;
+        auto& bank = voices.getUnchecked(voiceIndices[l])->getModeBank();
+        for (int m = 0; m < NUM_MODES; m++)
+        {
+            bank.y1[m] = g.y1[m][l];
+            bank.y2[m] = g.y2[m][l];
+        }
+        bank.x1 = g.x1[l];
+        bank.x2 = g.x2[l];
+        if (bank.rampChunks > 0)
+        {
+            // Coeficientes avanzados por la rampa en este bloque
+            for (int m = 0; m < NUM_MODES; m++)
+            {
+                bank.b0[m] = g.b0[m][l];
+                bank.b2[m] = g.b2[m][l];
+                bank.a1[m] = g.a1[m][l];
+                bank.a2[m] = g.a2[m][l];
+            }
+            bank.rampChunks = g.rampChunks[l];
+        }
+        
+        if (auto* formant = voices.getUnchecked(voiceIndices[l])->getFormantFilter())
+        {
+            formant->x1 = g.fx1[l]; formant->x2 = g.fx2[l];
+            formant->y1 = g.fy1[l]; formant->y2 = g.fy2[l];
+            if (formant->rampChunks > 0)
+            {
+                formant->b0 = g.fb0[l]; formant->b1 = g.fb1[l]; formant->b2 = g.fb2[l];
+                formant->a1 = g.fa1[l]; formant->a2 = g.fa2[l];
+                formant->rampChunks = g.formantRampChunks[l];
+            }
+        }
+    }
+}
+
+//==============================================================================
+void VoiceManager::stepLaneRamps(VoiceLaneGroup& g)
+{
+    // Máscara por lane (1 = rampa en curso) para que el loop de modos quede sin branches
+    float on[VOICE_LANES], formantOn[VOICE_LANES];
+    for (int l = 0; l < VOICE_LANES; l++)
+    {
+        on[l] = g.rampChunks[l] > 0 ? 1.0f : 0.0f;
+        formantOn[l] = g.formantRampChunks[l] > 0 ? 1.0f : 0.0f;
+        g.rampChunks[l] -= g.rampChunks[l] > 0 ? 1 : 0;
+        g.formantRampChunks[l] -= g.formantRampChunks[l] > 0 ? 1 : 0;
+    }
+    for (int m = 0; m < NUM_MODES; m++)
+    {
+        for (int l = 0; l < VOICE_LANES; l++)
+        {
+            g.b0[m][l] += g.db0[m][l] * on[l];
+            g.b2[m][l] += g.db2[m][l] * on[l];
+            g.a1[m][l] += g.da1[m][l] * on[l];
+            g.a2[m][l] += g.da2[m][l] * on[l];
+        }
+    }
+    for (int l = 0; l < VOICE_LANES; l++)
+    {
+        g.fb0[l] += g.fdb0[l] * formantOn[l];
+        g.fb1[l] += g.fdb1[l] * formantOn[l];
+        g.fb2[l] += g.fdb2[l] * formantOn[l];
+        g.fa1[l] += g.fda1[l] * formantOn[l];
+        g.fa2[l] += g.fda2[l] * formantOn[l];
     }
-    return nullptr;
 }
 
 //==============================================================================
-ModalVoice* VoiceManager::findVoiceToSteal(int quadrant)
+void VoiceManager::addActiveVoice(int voiceIndex)
 {
-    if (maxVoices == 0 || voices.size() == 0)
-        return nullptr;
+    if (activeSlot[(size_t)voiceIndex] >= 0)
+        return; // Robada: ya estaba en la lista
+    activeSlot[(size_t)voiceIndex] = (int)activeVoices.size();
+    activeVoices.push_back(voiceIndex); // Capacidad = poolSize (reservada en prepare)
+    activeVoiceCount.store((int)activeVoices.size(), std::memory_order_relaxed);
+}
+
+void VoiceManager::removeActiveVoice(int voiceIndex)
+{
+    int slot = activeSlot[(size_t)voiceIndex];
+    if (slot < 0)
+        return;
+    // Swap-remove: la última ocupa el hueco
+    int last = activeVoices.back();
+    activeVoices[(size_t)slot] = last;
+    activeSlot[(size_t)last] = slot;
+    activeVoices.pop_back();
+    activeSlot[(size_t)voiceIndex] = -1;
+    activeVoiceCount.store((int)activeVoices.size(), std::memory_order_relaxed);
+}
+
+//==============================================================================
+void VoiceManager::updateActiveVoices()
+{
+    // Recorrido inverso: el swap-remove solo mueve elementos ya visitados
+    for (int k = (int)activeVoices.size() - 1; k >= 0; k--)
+    {
+        int index = activeVoices[(size_t)k];
+        if (!voices.getUnchecked(index)->finishBlock(silenceFloorGain, silenceHoldBlocks))
+            removeActiveVoice(index);
+    }
+}
+
+//==============================================================================
+void VoiceManager::setSilenceFloor(float floorDb, int holdBlocks)
+{
+    silenceHoldBlocks = juce::jmax(1, holdBlocks);
+    if (floorDb != silenceFloorDb)
+    {
+        silenceFloorDb = floorDb;
+        silenceFloorGain = juce::Decibels::decibelsToGain(floorDb, -200.0f); // Sin el corte a -inf de -100 dB por defecto
+    }
+}
+
+//==============================================================================
+void VoiceManager::resetAll()
+{
+    // Con el audio parado (releaseResources): esperar a un worker atrasado antes de tocar sus voces
+    drainLateRenderWorkers();
+    
+    // RT-SAFE: Resetear todo el pool
+    for (int i = 0; i < poolSize; i++)
+    {
+        voices.getUnchecked(i)->reset();
+        voiceTriggerTime[(size_t)i] = -1;
+        voiceGainL[(size_t)i] = 1.0f;
+        voiceGainR[(size_t)i] = 1.0f;
+    }
     
-    int searchLimit = juce::jmin(maxVoices, (int)voices.size());
+    currentTime = 0;
+    rebuildRegions();
+}
+
+//==============================================================================
+int VoiceManager::regionForQuadrant(int quadrant) const
+{
     int reservedTotal = 4 * maxVoicesPerQuadrant;
+    if (quadrant >= 0 && quadrant < 4 && maxVoicesPerQuadrant > 0 && reservedTotal <= maxVoices)
+        return quadrant;
+    return SHARED_REGION;
+}
+
+//==============================================================================
+int VoiceManager::findAvailableVoice(int quadrant)
+{
+    auto popFree = [this](int r) -> int {
+        auto& freeList = regions[r].freeList;
+        if (freeList.empty())
+            return -1;
+        int index = freeList.back();
+        freeList.pop_back();
+        return index;
+    };
     
-    auto findBestInRange = [this, searchLimit](int start, int end) -> ModalVoice* {
-        ModalVoice* best = nullptr;
-        float minAmp = 1e9f;
-        int oldestTime = 2147483647;
-        for (int i = start; i < end && i < searchLimit; i++)
+    // Con reserva: la del cuadrante y luego el pool compartido (no consume reservas de otros cuadrantes)
+    int region = regionForQuadrant(quadrant);
+    if (region != SHARED_REGION)
+    {
+        int index = popFree(region);
+        return index >= 0 ? index : popFree(SHARED_REGION);
+    }
+    
+    // Sin cuadrante: cualquier región
+    for (int r = SHARED_REGION; r >= 0; r--)
+    {
+        int index = popFree(r);
+        if (index >= 0)
+            return index;
+    }
+    return -1;
+}
+
+//==============================================================================
+int VoiceManager::findVoiceToSteal(int quadrant)
+{
+    auto cmp = [this](int a, int b) { return stealsAfter(a, b); };
+    
+    // Preferir robar dentro del cuadrante, luego del compartido, luego el mejor global
+    int region = regionForQuadrant(quadrant);
+    int chosen = -1;
+    if (region != SHARED_REGION && !regions[region].stealHeap.empty())
+        chosen = region;
+    else if (region != SHARED_REGION && !regions[SHARED_REGION].stealHeap.empty())
+        chosen = SHARED_REGION;
+    else
+    {
+        for (int r = 0; r < NUM_REGIONS; r++)
         {
-            auto* v = voices.getUnchecked(i);
-            if (!v->isActive()) continue;
-            float a = v->getResidualAmplitude();
-            int t = voiceTriggerTime[i];
-            if (best == nullptr || a < minAmp || (std::abs(a - minAmp) < 0.0001f && t < oldestTime))
-            {
-                best = v;
-                minAmp = a;
-                oldestTime = t;
-            }
+            auto& heap = regions[r].stealHeap;
+            if (heap.empty())
+                continue;
+            if (chosen < 0 || stealsAfter(regions[chosen].stealHeap.front(), heap.front()))
+                chosen = r;
         }
-        return best;
-    };
+    }
+    if (chosen < 0)
+        return -1;
+    
+    auto& heap = regions[chosen].stealHeap;
+    std::pop_heap(heap.begin(), heap.end(), cmp);
+    int index = heap.back();
+    heap.pop_back();
+    
+    voices.getUnchecked(index)->reset();
+    return index;
+}
+
+//==============================================================================
+bool VoiceManager::stealsAfter(int a, int b) const
+{
+    // Menor amplitud residual se roba primero; empate: la más antigua
+    float pa = voicePriority[(size_t)a];
+    float pb = voicePriority[(size_t)b];
+    if (pa != pb)
+        return pa > pb;
+    return voiceTriggerTime[(size_t)a] > voiceTriggerTime[(size_t)b];
+}
+
+//==============================================================================
+void VoiceManager::applyPendingLayout()
+{
+    // rebuildRegions recorre todas las voces: las de un worker atrasado esperan a que termine
+    if (poolSize == 0 || lateRenderWorkers != 0)
+        return;
+    int requested = juce::jlimit(MIN_VOICES_LIMIT, poolSize, requestedMaxVoices.load(std::memory_order_relaxed));
+    int requestedPerQuadrant = requestedVoicesPerQuadrant.load(std::memory_order_relaxed);
+    if (requested == maxVoices && requestedPerQuadrant == maxVoicesPerQuadrant)
+        return;
+    maxVoices = requested;
+    maxVoicesPerQuadrant = requestedPerQuadrant;
+    rebuildRegions();
+}
+
+//==============================================================================
+void VoiceManager::rebuildRegions()
+{
+    // RT-SAFE: solo clear/push_back dentro de la capacidad reservada en prepare
+    for (auto& region : regions)
+    {
+        region.freeList.clear();
+        region.stealHeap.clear();
+    }
+    
+    for (int i = 0; i < poolSize; i++)
+    {
+        auto* voice = voices.getUnchecked(i);
+        if (i >= maxVoices)
+        {
+            // Fuera del límite activo: silenciar y sacar de la asignación
+            voiceRegion[(size_t)i] = -1;
+            if (voice->isActive())
+                voice->reset();
+            removeActiveVoice(i);
+            continue;
+        }
+        int reservedTotal = 4 * maxVoicesPerQuadrant;
+        int region = (maxVoicesPerQuadrant > 0 && reservedTotal <= maxVoices && i < reservedTotal)
+            ? i / maxVoicesPerQuadrant : SHARED_REGION;
+        voiceRegion[(size_t)i] = region;
+        if (voice->isActive())
+        {
+            voicePriority[(size_t)i] = voice->getResidualAmplitude();
+            regions[region].stealHeap.push_back(i);
+            addActiveVoice(i);
+        }
+        else
+        {
+            removeActiveVoice(i);
+        }
+    }
     
-    ModalVoice* toSteal = nullptr;
-    if (quadrant >= 0 && quadrant < 4 && reservedTotal <= maxVoices)
+    // Free lists en orden descendente: el pop devuelve primero el índice más bajo (voces compactas).
+    // Acotado al pool: antes de prepare() (reset desde el constructor del engine) el pool está vacío.
+    for (int i = juce::jmin(maxVoices, poolSize) - 1; i >= 0; i--)
     {
-        int quadStart = quadrant * maxVoicesPerQuadrant;
-        int quadEnd = juce::jmin(quadStart + maxVoicesPerQuadrant, searchLimit);
-        toSteal = findBestInRange(quadStart, quadEnd);
-        if (!toSteal)
-            toSteal = findBestInRange(reservedTotal, searchLimit);
+        if (!voices.getUnchecked(i)->isActive())
+            regions[voiceRegion[(size_t)i]].freeList.push_back(i);
     }
-    if (!toSteal)
-        toSteal = findBestInRange(0, searchLimit);
     
-    if (toSteal)
-        toSteal->reset();
-    return toSteal;
+    auto cmp = [this](int a, int b) { return stealsAfter(a, b); };
+    for (auto& region : regions)
+        std::make_heap(region.stealHeap.begin(), region.stealHeap.end(), cmp);
+}
+
+//==============================================================================
+void VoiceManager::refreshStealHeaps()
+{
+    // O(voces activas) por bloque: las terminadas vuelven a la free list, el resto actualiza su clave
+    auto cmp = [this](int a, int b) { return stealsAfter(a, b); };
+    for (auto& region : regions)
+    {
+        auto& heap = region.stealHeap;
+        size_t kept = 0;
+        for (size_t k = 0; k < heap.size(); k++)
+        {
+            int index = heap[k];
+            auto* voice = voices.getUnchecked(index);
+            if (voice->isActive())
+            {
+                voicePriority[(size_t)index] = voice->getResidualAmplitude();
+                heap[kept++] = index;
+            }
+            else
+            {
+                region.freeList.push_back(index);
+            }
+        }
+        heap.resize(kept);
+        std::make_heap(heap.begin(), heap.end(), cmp);
+    }
 }
 
 //==============================================================================
 void VoiceManager::updateVoiceTime(int voiceIndex)
 {
-    // RT-SAFE: Actualizar tiempo usando array fijo pre-allocado
-    if (voiceIndex >= 0 && voiceIndex < MAX_VOICES_LIMIT)
+    // RT-SAFE: Actualizar tiempo (vector dimensionado en prepare)
+    if (voiceIndex >= 0 && voiceIndex < poolSize)
     {
-        voiceTriggerTime[voiceIndex] = currentTime;
+        voiceTriggerTime[(size_t)voiceIndex] = currentTime;
     }
 }
 
 //==============================================================================
 void VoiceManager::updateGlobalParameters(float metalness, float brightness, float damping)
 {
-    // RT-SAFE: Actualizar parámetros globales en todas las voces activas
-    // Mantener frecuencia base y amplitud actuales de cada voz
-    if (maxVoices == 0 || voices.size() == 0)
+    // RT-SAFE: solo registra el destino; applyGlobalParameterUpdates lo reparte entre bloques
+    globalMetalness = metalness;
+    globalBrightness = brightness;
+    globalDamping = damping;
+    globalParamsVersion++;
+    globalParamsPending = true;
+}
+
+//==============================================================================
+void VoiceManager::applyGlobalParameterUpdates()
+{
+    if (!globalParamsPending)
         return;
     
-    int searchLimit = juce::jmin(maxVoices, voices.size());
-    for (int i = 0; i < searchLimit; i++)
+    // Round-robin sobre la lista activa desde el cursor; voces ya al día se saltan sin coste de diseño
+    const int numActive = (int)activeVoices.size();
+    int budget = COEFF_UPDATES_PER_BLOCK;
+    bool stale = false;
+    for (int k = 0; k < numActive; k++)
     {
-        auto* voice = voices.getUnchecked(i);
-        
-        // Solo actualizar voces activas
-        if (voice->isActive())
-            voice->setGlobalParametersOnly(metalness, brightness, damping);
+        int slot = (globalUpdateCursor + k) % numActive;
+        int index = activeVoices[(size_t)slot];
+        if (voiceParamsVersion[(size_t)index] == globalParamsVersion)
+            continue;
+        if (budget == 0)
+        {
+            stale = true;
+            globalUpdateCursor = slot;
+            break;
+        }
+        // Mantener frecuencia base y amplitud actuales de cada voz; coeficientes por rampa
+        voices.getUnchecked(index)->setGlobalParametersOnly(globalMetalness, globalBrightness, globalDamping, true);
+        voiceParamsVersion[(size_t)index] = globalParamsVersion;
+        budget--;
     }
+    globalParamsPending = stale;
 }
@@ -2,6 +2,9 @@
 
 #include <JuceHeader.h>
 #include "ModalVoice.h"
+#include <atomic>
+#include <memory>
+#include <vector>
 
 //==============================================================================
 /**
@@ -9,17 +12,33 @@
     
     Gestiona un pool de voces, asigna voces disponibles y implementa voice stealing
     cuando todas las voces están activas.
+    
+    Asignación sin scans: cada región (reserva de cuadrante 0..3 + pool compartido) tiene
+    una free list (pop O(1)) y un min-heap de voces activas por (amplitud residual, edad)
+    para robar en O(log n). Los heaps se reordenan una vez por bloque tras el render.
+    
+    Render solo de voces sonando: lista compacta de índices activos (alta en trigger, baja
+    al terminar la voz, detectada una vez por bloque); las voces idle del pool no cuestan nada.
+    
+    Render multihilo opcional: hilos auxiliares creados al habilitarlos (setRenderWorkers) toman
+    grupos de VOICE_LANES voces de la lista activa (handoff por atómicos, sin locks ni allocations
+    en el audio thread) y mezclan en su propio scratch; el audio thread también toma grupos y suma
+    los scratch al final del bloque. La espera está acotada: un worker atrasado se deja fuera del
+    bloque y su mezcla entra en el primer bloque en el que haya terminado.
 */
 class VoiceManager
 {
 public:
     //==============================================================================
     VoiceManager();
-    ~VoiceManager() = default;
+    ~VoiceManager();
 
     //==============================================================================
-    /** Prepara el gestor con el sample rate y número máximo de voces */
-    void prepare(double sampleRate, int maxVoices);
+    /** Prepara el gestor con el sample rate, número máximo de voces y tamaño del pool
+     *  pre-allocado (no RT: allocations solo aquí). poolSize se limita a MIN_VOICES_LIMIT..MAX_POOL_SIZE. */
+    static constexpr int DEFAULT_POOL_SIZE = 256;
+    static constexpr int MAX_POOL_SIZE = 1024;
+    void prepare(double sampleRate, int maxVoices, int poolSize = DEFAULT_POOL_SIZE);
 
     /** Obtiene una voz disponible y la configura, o roba una si es necesario.
      *  gainL, gainR: pan constant-power (1,1 = centro/mono).
@@ -34,56 +53,253 @@ public:
     /** Renderiza todas las voces activas en el buffer */
     void renderNextBlock(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
 
-    /** Obtiene el número de voces activas */
-    int getActiveVoiceCount() const;
+    /** Obtiene el número de voces activas (O(1), thread-safe: publicado al final de cada bloque/trigger) */
+    int getActiveVoiceCount() const { return activeVoiceCount.load(std::memory_order_relaxed); }
 
     /** Obtiene el número máximo de voces */
-    int getMaxVoices() const { return maxVoices; }
+    int getMaxVoices() const { return requestedMaxVoices.load(std::memory_order_relaxed); }
 
-    /** Establece el número máximo de voces (requiere prepare) */
+    /** Tamaño del pool pre-allocado en el último prepare (límite superior de setMaxVoices). Thread-safe. */
+    int getPoolSize() const { return preparedPoolSize.load(std::memory_order_relaxed); }
+
+    /** Establece el número máximo de voces, limitado al pool preparado (thread-safe: se aplica en el
+     *  audio thread al siguiente bloque/trigger) */
     void setMaxVoices(int newMaxVoices);
 
     /** Voces reservadas por cuadrante (0..3); resto compartidas. Default 2. */
     static constexpr int DEFAULT_MAX_VOICES_PER_QUADRANT = 2;
     void setMaxVoicesPerQuadrant(int n);
-    int getMaxVoicesPerQuadrant() const { return maxVoicesPerQuadrant; }
+    int getMaxVoicesPerQuadrant() const { return requestedVoicesPerQuadrant.load(std::memory_order_relaxed); }
 
     /** Resetea todas las voces */
     void resetAll();
 
-    /** Actualiza parámetros globales en todas las voces activas (RT-safe) */
+    /** Fija nuevos parámetros globales para las voces activas (RT-safe, audio thread). El rediseño
+     *  se reparte entre bloques (COEFF_UPDATES_PER_BLOCK voces por bloque) y cada voz llega a sus
+     *  nuevos coeficientes por rampa lineal: sin pico de CPU ni zipper en barridos. */
     void updateGlobalParameters(float metalness, float brightness, float damping);
 
+    /** Hilos auxiliares de render de voces (0 = solo audio thread, default; hasta MAX_RENDER_WORKERS y
+     *  nº de CPUs - 1). Cada hilo se crea la primera vez que se pide y vive hasta el destructor; al bajar
+     *  el número quedan bloqueados sin consumir CPU. Message thread.
+     *  waitForWorkers = false (tiempo real): el audio thread espera a los workers como mucho WORKER_WAIT_US.
+     *  true (render offline): espera siempre a que terminen; la salida no depende del scheduler. */
+    static constexpr int MAX_RENDER_WORKERS = 7;
+    void setRenderWorkers(int numWorkers, bool waitForWorkers = false);
+    int getRenderWorkers() const { return enabledRenderWorkers.load(std::memory_order_relaxed); }
+
+    /** Bloques en los que un worker no terminó a tiempo (desde el arranque): sus voces no suenan en ese
+     *  bloque y su mezcla se suma al primero en el que haya terminado (hasta entonces, un solo hilo). Thread-safe. */
+    int getRenderWorkerStalls() const { return renderWorkerStalls.load(std::memory_order_relaxed); }
+
+    /** Render voices-across-lanes (default): los biquads de VOICE_LANES voces avanzan juntos en SIMD.
+     *  false = render por voz (ModalVoice::renderBlock). RT-safe: solo cambia el camino de render. */
+    void setVoiceLaneRendering(bool enabled) { voiceLaneRendering = enabled; }
+    bool getVoiceLaneRendering() const { return voiceLaneRendering; }
+
+    /** Fin temprano de voces: una cola cuyo pico de bloque queda bajo floorDb (dBFS) durante
+     *  holdBlocks bloques seguidos se termina. Llamar desde el audio thread (p. ej. por bloque). */
+    static constexpr float DEFAULT_SILENCE_FLOOR_DB = -90.0f;
+    static constexpr int DEFAULT_SILENCE_HOLD_BLOCKS = 3;
+    void setSilenceFloor(float floorDb, int holdBlocks);
+
 private:
     //==============================================================================
     static constexpr int DEFAULT_MAX_VOICES = 8;
-    static constexpr int MAX_VOICES_LIMIT = 32; // Pre-allocar hasta este límite
     static constexpr int MIN_VOICES_LIMIT = 4;
+    static constexpr int NUM_REGIONS = 5;       // Regiones de asignación: cuadrantes 0..3 + compartido
+    static constexpr int SHARED_REGION = 4;
+    static constexpr int RENDER_SCRATCH_SAMPLES = 256; // Scratch por voz en renderNextBlock (stack)
+    static constexpr int VOICE_LANES = 8;       // Voces por grupo SIMD (1x AVX, 2x SSE/NEON)
+    static constexpr int LANE_CHUNK = ModalVoice::RENDER_CHUNK;
+    static constexpr int NUM_MODES = ModalVoice::NUM_MODES;
+    static constexpr int COEFF_UPDATES_PER_BLOCK = 8; // Voces rediseñadas por bloque tras un cambio de parámetros globales
 
     //==============================================================================
     double currentSampleRate = 44100.0;
-    int maxVoices = DEFAULT_MAX_VOICES; // Límite activo (puede ser menor que MAX_VOICES_LIMIT)
-    int maxVoicesPerQuadrant = DEFAULT_MAX_VOICES_PER_QUADRANT; // Reserva por cuadrante (R4)
+    int poolSize = 0;                   // Voces pre-allocadas
+    std::atomic<int> preparedPoolSize{DEFAULT_POOL_SIZE}; // poolSize para lectores fuera del audio thread
+    int maxVoices = DEFAULT_MAX_VOICES; // Límite activo (puede ser menor que poolSize); solo audio thread
+    int maxVoicesPerQuadrant = DEFAULT_MAX_VOICES_PER_QUADRANT; // Reserva por cuadrante (R4); solo audio thread
+    std::atomic<int> requestedMaxVoices{DEFAULT_MAX_VOICES};
+    std::atomic<int> requestedVoicesPerQuadrant{DEFAULT_MAX_VOICES_PER_QUADRANT};
     
-    // RT-SAFE: Pre-allocado array fijo de voces (no allocations en runtime)
+    // RT-SAFE: Pool pre-allocado en prepare (no allocations en runtime)
     juce::OwnedArray<ModalVoice> voices;
     
+    // Excitaciones precalculadas compartidas por todas las voces (reconstruidas en prepare)
+    ExcitationTables excitationTables;
+    
     // Contador de tiempo para voice stealing (voces más antiguas)
-    // RT-SAFE: Array fijo pre-allocado
-    int voiceTriggerTime[MAX_VOICES_LIMIT];
+    // RT-SAFE: vectores dimensionados en prepare
+    std::vector<int> voiceTriggerTime;
     int currentTime = 0;
     
     // Pan constant-power por voz (aplicado en renderNextBlock)
-    float voiceGainL[MAX_VOICES_LIMIT];
-    float voiceGainR[MAX_VOICES_LIMIT];
+    std::vector<float> voiceGainL;
+    std::vector<float> voiceGainR;
+    
+    // Asignación: región de cada voz (-1 = fuera de maxVoices) y clave de robo (residual al final del bloque)
+    struct Region
+    {
+        std::vector<int> freeList;   // Pila de índices libres (capacidad = poolSize)
+        std::vector<int> stealHeap;  // Índices activos, min-heap por (voicePriority, voiceTriggerTime)
+    };
+    Region regions[NUM_REGIONS];
+    std::vector<int> voiceRegion;
+    std::vector<float> voicePriority;
+    
+    // Voces sonando: lista compacta (orden arbitrario, baja por swap-remove) y posición de cada voz (-1 = idle)
+    std::vector<int> activeVoices;
+    std::vector<int> activeSlot;
+    std::atomic<int> activeVoiceCount{0};
+    
+    // Parámetros globales pendientes de aplicar (round-robin sobre la lista activa)
+    float globalMetalness = 0.5f;
+    float globalBrightness = 0.5f;
+    float globalDamping = 0.5f;
+    int globalParamsVersion = 0;
+    bool globalParamsPending = false;
+    int globalUpdateCursor = 0;
+    std::vector<int> voiceParamsVersion; // Versión de parámetros globales aplicada a cada voz
+    
+    /** Pool SoA de un grupo de VOICE_LANES voces: coeficientes y estados de cada modo contiguos
+     *  por lane, para que un modo de 8 voces avance en una instrucción (también el formant).
+     *  Gather desde las voces al inicio del bloque, scatter de estados al final; lanes inactivas
+     *  con coeficientes 0. */
+    struct alignas(32) VoiceLaneGroup
+    {
+        float b0[NUM_MODES][VOICE_LANES], b2[NUM_MODES][VOICE_LANES];
+        float a1[NUM_MODES][VOICE_LANES], a2[NUM_MODES][VOICE_LANES];
+        float y1[NUM_MODES][VOICE_LANES], y2[NUM_MODES][VOICE_LANES];
+        float x1[VOICE_LANES], x2[VOICE_LANES];
+        
+        // Formant peaking por voz (identidad en lanes sin formant)
+        float fb0[VOICE_LANES], fb1[VOICE_LANES], fb2[VOICE_LANES], fa1[VOICE_LANES], fa2[VOICE_LANES];
+        float fx1[VOICE_LANES], fx2[VOICE_LANES], fy1[VOICE_LANES], fy2[VOICE_LANES];
+        
+        // Rampas de coeficientes en curso (delta por segmento; pasos restantes por lane)
+        float db0[NUM_MODES][VOICE_LANES], db2[NUM_MODES][VOICE_LANES];
+        float da1[NUM_MODES][VOICE_LANES], da2[NUM_MODES][VOICE_LANES];
+        float fdb0[VOICE_LANES], fdb1[VOICE_LANES], fdb2[VOICE_LANES], fda1[VOICE_LANES], fda2[VOICE_LANES];
+        int rampChunks[VOICE_LANES], formantRampChunks[VOICE_LANES];
+    };
+    VoiceLaneGroup laneGroup; // Scratch reusado por grupo (audio thread; cada worker tiene el suyo)
+    bool voiceLaneRendering = true;
+    
+    // Render multihilo: estado del bloque publicado por el audio thread.
+    // jobState = generación (32 bits) | nº de jobs (16) | próximo job (16); un job = un grupo de VOICE_LANES voces.
+    // Los workers reclaman jobs por CAS, así un worker que llega tarde nunca bloquea el bloque.
+    // Un job se reclama en dos pasos: índice por jobState y luego jobClaims[job] de abierto (generación << 8) a
+    // tomado (| quién) por CAS; un worker con un índice de un bloque anterior falla el CAS. Al terminar se marca
+    // JOB_DONE. Si tras WORKER_WAIT_US quedan jobs, el audio thread roba los que nadie tomó; un worker con un job
+    // a medio renderizar queda atrasado: sus voces salen de la lista activa y de los heaps (nadie más las toca),
+    // no se publica otro bloque y al terminar su scratch se suma a la salida y las voces vuelven.
+    static constexpr int WORKER_SCRATCH_SAMPLES = 4096; // Bloques mayores se renderizan solo en el audio thread
+    static constexpr double WORKER_SPIN_FRACTION = 0.25; // Un worker sin trabajo hace spin esta fracción del bloque y luego duerme
+    static constexpr double WORKER_WAIT_US = 100.0;     // Espera del audio thread antes de robar jobs reclamados
+    static constexpr int MAX_RENDER_JOBS = MAX_POOL_SIZE / VOICE_LANES;
+    static constexpr juce::uint64 JOB_AUDIO_THREAD = 1;  // Quién tomó el job (0 = abierto)
+    static constexpr juce::uint64 JOB_WORKER = 2;        // + índice del worker
+    static constexpr juce::uint64 JOB_CLAIMANT_MASK = 0x7F;
+    static constexpr juce::uint64 JOB_DONE = 0x80;
+    struct RenderWorker;
+    std::unique_ptr<RenderWorker> renderWorkers[MAX_RENDER_WORKERS]; // Creados en setRenderWorkers (message thread)
+    std::atomic<int> startedRenderWorkers{0};          // Publicado (release) tras crear cada worker
+    std::atomic<int> enabledRenderWorkers{0};
+    std::atomic<bool> waitForRenderWorkers{false};
+    std::atomic<juce::uint64> jobState{0};
+    std::atomic<juce::uint64> jobClaims[MAX_RENDER_JOBS]; // Quien gana el CAS renderiza el job
+    std::atomic<int> jobsCompleted{0};
+    std::atomic<int> renderWorkerStalls{0};
+    juce::uint32 jobGeneration = 0;
+    std::vector<int> jobVoices;      // Copia de la lista activa del bloque publicado (capacidad = poolSize)
+    int jobVoiceCount = 0;
+    int jobCount = 0;
+    int jobNumSamples = 0;
+    bool jobStereo = true;
+    
+    // Workers atrasados en jobGeneration (bit por worker; solo audio thread): sus voces están fuera hasta que su
+    // scratch se sumó entero. lateMixOffset < 0: aún renderiza; >= 0: samples de su scratch ya sumados.
+    int lateRenderWorkers = 0;
+    int lateMixOffset[MAX_RENDER_WORKERS] = {};
+    
+    // Piso de silencio para fin temprano (solo audio thread)
+    float silenceFloorDb = DEFAULT_SILENCE_FLOOR_DB;
+    float silenceFloorGain = juce::Decibels::decibelsToGain(DEFAULT_SILENCE_FLOOR_DB, -200.0f);
+    int silenceHoldBlocks = DEFAULT_SILENCE_HOLD_BLOCKS;
     
     //==============================================================================
-    /** Encuentra una voz disponible; quadrant 0..3 prioriza reserva por cuadrante, -1 = todas */
-    ModalVoice* findAvailableVoice(int quadrant = -1);
+    /** Índice de una voz libre (pop de free list); quadrant 0..3 prioriza su reserva, -1 = todas. -1 si no hay. */
+    int findAvailableVoice(int quadrant = -1);
 
-    /** Encuentra la mejor voz para robar; quadrant 0..3 prefiere robar de ese cuadrante */
-    ModalVoice* findVoiceToSteal(int quadrant = -1);
+    /** Índice de la mejor voz para robar (tope de heap, O(log n)); quadrant 0..3 prefiere su región. */
+    int findVoiceToSteal(int quadrant = -1);
 
     /** Actualiza el tiempo de trigger de una voz */
     void updateVoiceTime(int voiceIndex);
+
+    /** Orden del heap de robo: true si a debe robarse después que b (min-heap) */
+    bool stealsAfter(int a, int b) const;
+
+    /** Aplica maxVoices / reserva por cuadrante pendientes (audio thread) */
+    void applyPendingLayout();
+
+    /** Recalcula regiones, free lists y heaps desde el estado de las voces (O(maxVoices), sin allocations) */
+    void rebuildRegions();
+
+    /** Tras el render: voces terminadas vuelven a la free list; heaps reordenados con la residual actual */
+    void refreshStealHeaps();
+
+    /** Alta/baja O(1) en la lista de voces activas */
+    void addActiveVoice(int voiceIndex);
+    void removeActiveVoice(int voiceIndex);
+
+    /** Rediseña (con rampa) hasta COEFF_UPDATES_PER_BLOCK voces activas con parámetros globales atrasados */
+    void applyGlobalParameterUpdates();
+
+    /** Un paso de las rampas de coeficientes de las lanes del grupo */
+    static void stepLaneRamps(VoiceLaneGroup& g);
+
+    /** Tras el render: cierra el tracker de nivel de cada voz y da de baja las que terminaron en
+     *  este bloque (envolvente idle o cola bajo el piso de silencio) */
+    void updateActiveVoices();
+
+    /** Región de asignación del cuadrante (SHARED_REGION si no aplica reserva) */
+    int regionForQuadrant(int quadrant) const;
+
+    /** Render por voz (ModalVoice::renderBlock) de numVoices voces (índices en voiceIndices) */
+    void renderVoicesSerial(const int* voiceIndices, int numVoices, float* leftChannel, float* rightChannel, int numSamples);
+
+    /** Render voices-across-lanes de numLanes voces (índices en voiceIndices) con el scratch g */
+    void renderVoiceGroup(VoiceLaneGroup& g, const int* voiceIndices, int numLanes, float* left, float* right, int numSamples);
+
+    /** Reparte la lista activa entre el audio thread y numWorkers workers y suma sus mezclas */
+    void renderVoicesParallel(float* left, float* right, int numSamples, int numWorkers);
+
+    /** Reclama y renderiza un job de la generación dada. worker == nullptr: audio thread (mezcla
+     *  directa en left/right); si no, en el scratch del worker. false si no quedan jobs. */
+    bool runRenderJob(juce::uint32 generation, VoiceLaneGroup& g, float* left, float* right, RenderWorker* worker);
+
+    /** Toma el job para esta generación (CAS sobre jobClaims). false si otro hilo ya lo tomó o el bloque pasó. */
+    bool claimRenderJob(int job, juce::uint32 generation, juce::uint64 claimant);
+
+    /** Renderiza el job (ya tomado) y lo marca completado */
+    void renderJob(int job, VoiceLaneGroup& g, float* left, float* right);
+
+    /** Recorre los jobs de jobGeneration: workers que tomaron alguno (participants) y, como retorno, los
+     *  que tienen uno sin terminar (bit por worker) */
+    int scanRenderJobs(int& participants) const;
+
+    /** Voces de un job atrasado fuera de la lista activa y del heap de robo / de vuelta al terminar */
+    void detachRenderJobVoices(int job);
+    void reattachRenderJobVoices(int job);
+
+    /** Workers atrasados que ya terminaron: suma su scratch en left/right (al inicio del bloque; nullptr =
+     *  descartar) y, tras el render, devuelve sus voces a la lista activa y a los heaps */
+    void mixLateRenderWorkers(float* left, float* right, int numSamples);
+    void reattachLateRenderWorkers();
+
+    /** Espera a los workers atrasados y descarta su mezcla (prepare/resetAll, con el audio parado) */
+    void drainLateRenderWorkers();
 };
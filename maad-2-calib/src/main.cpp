@@ -19,12 +19,27 @@
 #include <fstream>
 #include <iomanip>
 #include <sstream>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <unordered_map>
 
-// TODO: Incluir librerías OSC (ej: liblo, oscpack, o similar)
-// #include <lo/lo.h>  // ejemplo con liblo
-
-// TODO: Incluir librerías de captura de audio (ej: PortAudio, RtAudio)
-// #include <portaudio.h>  // ejemplo con PortAudio
+// Recepción OSC por UDP (POSIX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
 
 /**
  * Estructura para representar un evento OSC capturado
@@ -36,25 +51,1037 @@ struct OSCEvent {
     std::string wall_clock;     // Timestamp absoluto ISO 8601
 };
 
+/**
+ * Valor de un argumento OSC según su tag de tipo (equivalente a lo_arg de liblo; s apunta a la string)
+ */
+union OSCArgValue {
+    int32_t i;      // 'i'
+    float f;        // 'f'
+    int64_t h;      // 'h'
+    double d;       // 'd'
+    const char* s;  // 's' / 'S'
+};
+
+/**
+ * Registro binario de tamaño fijo de un evento OSC (run.bin).
+ * Trivialmente copiable: se escribe tal cual al ring y al archivo, sin formatear en el hilo de recepción.
+ */
+struct EventRecord {
+    static constexpr int MAX_ARGS = 8;          // /hit con seq/count usa 7; con t_us (sonda de latencia), 8
+    static constexpr int ADDRESS_SIZE = 32;
+    static constexpr int TEXT_SIZE = 32;        // Bytes para todos los argumentos string
+    static constexpr uint8_t FLAG_TRUNCATED = 1; // Dirección, argumentos o texto recortados
+
+    int64_t t_ns;                   // steady_clock desde el inicio de sesión
+    int64_t wall_ns;                // system_clock desde epoch (UTC)
+    char address[ADDRESS_SIZE];     // NUL-terminada
+    char types[MAX_ARGS];           // Tags OSC ('i', 'f', 'h', 'd', 's', 'S', 'T', 'F', 'N')
+    uint8_t num_args;
+    uint8_t flags;
+    uint8_t reserved[6];
+    union {
+        int64_t i;
+        double d;
+        struct { uint16_t offset, length; } text; // Strings: rango dentro de text[]
+    } values[MAX_ARGS];
+    char text[TEXT_SIZE];
+};
+static_assert(sizeof(EventRecord) == 160, "EventRecord: layout fijo del formato run.bin");
+
+/**
+ * Cabecera de run.bin (64 bytes), seguida de EventRecord consecutivos
+ */
+struct SessionFileHeader {
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];              // "MAADEVT1"
+    uint32_t version;
+    uint32_t record_size;       // sizeof(EventRecord)
+    int64_t start_wall_ns;      // system_clock en timestamp 0
+    uint64_t record_count;      // Se completa al cerrar (0 = sesión no cerrada: usar el tamaño del archivo)
+    uint64_t dropped_count;     // Eventos descartados con el ring lleno
+    char session_id[24];
+};
+static_assert(sizeof(SessionFileHeader) == 64, "SessionFileHeader: layout fijo del formato run.bin");
+
+static const char SESSION_FILE_MAGIC[8] = { 'M', 'A', 'A', 'D', 'E', 'V', 'T', '1' };
+
+/**
+ * Copia una string recortada a un campo fijo (siempre NUL-terminado). Devuelve false si se recortó.
+ */
+static bool copyFixed(char* dst, size_t dst_size, const char* src) {
+    size_t len = std::strlen(src);
+    bool fits = len < dst_size;
+    size_t n = fits ? len : dst_size - 1;
+    std::memcpy(dst, src, n);
+    dst[n] = '\0';
+    return fits;
+}
+
+/**
+ * Llena un registro a partir de un mensaje OSC ya parseado. Sin allocations ni formateo.
+ */
+static void fillEventRecord(EventRecord& rec, int64_t t_ns, int64_t wall_ns, const char* address,
+                            const char* types, const OSCArgValue* argv, int argc) {
+    std::memset(&rec, 0, sizeof(rec));
+    rec.t_ns = t_ns;
+    rec.wall_ns = wall_ns;
+    if (!copyFixed(rec.address, sizeof(rec.address), address)) {
+        rec.flags |= EventRecord::FLAG_TRUNCATED;
+    }
+
+    int n = argc < EventRecord::MAX_ARGS ? argc : EventRecord::MAX_ARGS;
+    if (n < argc) {
+        rec.flags |= EventRecord::FLAG_TRUNCATED;
+    }
+    uint16_t text_used = 0;
+    for (int k = 0; k < n; k++) {
+        char t = types[k];
+        rec.types[k] = t;
+        switch (t) {
+            case 'i': rec.values[k].i = argv[k].i; break;
+            case 'h': rec.values[k].i = argv[k].h; break;
+            case 'f': rec.values[k].d = argv[k].f; break;
+            case 'd': rec.values[k].d = argv[k].d; break;
+            case 's':
+            case 'S': {
+                size_t len = std::strlen(argv[k].s);
+                size_t room = EventRecord::TEXT_SIZE - text_used;
+                if (len > room) {
+                    len = room;
+                    rec.flags |= EventRecord::FLAG_TRUNCATED;
+                }
+                std::memcpy(rec.text + text_used, argv[k].s, len);
+                rec.values[k].text.offset = text_used;
+                rec.values[k].text.length = (uint16_t)len;
+                text_used = (uint16_t)(text_used + len);
+                break;
+            }
+            default: break; // 'T', 'F', 'N' no llevan valor; otros tags se convierten a null
+        }
+    }
+    rec.num_args = (uint8_t)n;
+}
+
+/**
+ * Escribe un registro como línea NDJSON (formato de run.ndjson, ver CALIB_SPEC.md)
+ */
+static void writeNdjsonLine(std::FILE* out, const EventRecord& rec) {
+    // wall_clock ISO 8601 con microsegundos
+    int64_t wall_s = rec.wall_ns / 1000000000;
+    int64_t wall_us = (rec.wall_ns % 1000000000) / 1000;
+    if (wall_us < 0) {
+        wall_s -= 1;
+        wall_us += 1000000;
+    }
+    std::time_t wall_time_t = (std::time_t)wall_s;
+    std::tm wall_tm{};
+#if defined(_WIN32)
+    gmtime_s(&wall_tm, &wall_time_t);
+#else
+    gmtime_r(&wall_time_t, &wall_tm);
+#endif
+    char wall[40];
+    std::strftime(wall, sizeof(wall), "%Y-%m-%dT%H:%M:%S", &wall_tm);
+
+    std::fprintf(out, "{\"timestamp\": %.6f, \"osc_address\": \"", (double)rec.t_ns * 1e-9);
+    for (const char* c = rec.address; *c; c++) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', out);
+        std::fputc(*c, out);
+    }
+    std::fputs("\", \"osc_args\": [", out);
+
+    for (int k = 0; k < rec.num_args; k++) {
+        if (k > 0) std::fputs(", ", out);
+        switch (rec.types[k]) {
+            case 'i':
+            case 'h':
+                std::fprintf(out, "%lld", (long long)rec.values[k].i);
+                break;
+            case 'f':
+            case 'd': {
+                double v = rec.values[k].d;
+                if (!std::isfinite(v)) {
+                    std::fputs("null", out); // JSON no admite NaN/Inf
+                    break;
+                }
+                // %.9g conserva float32 exacto; ".0" mantiene el tipo float en el lector
+                char num[32];
+                std::snprintf(num, sizeof(num), rec.types[k] == 'f' ? "%.9g" : "%.17g", v);
+                std::fputs(num, out);
+                if (!std::strpbrk(num, ".eE")) std::fputs(".0", out);
+                break;
+            }
+            case 's':
+            case 'S': {
+                std::fputc('"', out);
+                const char* s = rec.text + rec.values[k].text.offset;
+                for (uint16_t j = 0; j < rec.values[k].text.length; j++) {
+                    unsigned char c = (unsigned char)s[j];
+                    if (c == '"' || c == '\\') std::fprintf(out, "\\%c", c);
+                    else if (c < 0x20) std::fprintf(out, "\\u%04x", c);
+                    else std::fputc(c, out);
+                }
+                std::fputc('"', out);
+                break;
+            }
+            case 'T': std::fputs("true", out); break;
+            case 'F': std::fputs("false", out); break;
+            default: std::fputs("null", out); break;
+        }
+    }
+    std::fprintf(out, "], \"wall_clock\": \"%s.%06lldZ\"}\n", wall, (long long)wall_us);
+}
+
+/**
+ * Ring lock-free de un productor y un consumidor, pre-allocado (eventos OSC, bloques de audio).
+ * push() nunca bloquea: con el ring lleno descarta el elemento y lo cuenta.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity_pow2)
+        : slots(capacity_pow2), mask(capacity_pow2 - 1) {}
+
+    bool push(const T& item) {
+        T* slot = beginWrite();
+        if (!slot) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        *slot = item;
+        endWrite();
+        return true;
+    }
+
+    /** Slot libre para escribir en el lugar (productor), nullptr con el ring lleno. Se publica con endWrite(). */
+    T* beginWrite() {
+        uint64_t w = write_index.load(std::memory_order_relaxed);
+        if (w - read_index.load(std::memory_order_acquire) > mask) {
+            return nullptr;
+        }
+        return &slots[w & mask];
+    }
+
+    void endWrite() {
+        write_index.store(write_index.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /** Elementos listos en hasta dos tramos contiguos (consumidor) */
+    size_t peek(const T*& first, size_t& first_count, const T*& second, size_t& second_count) const {
+        uint64_t r = read_index.load(std::memory_order_relaxed);
+        size_t available = (size_t)(write_index.load(std::memory_order_acquire) - r);
+        size_t start = (size_t)(r & mask);
+        first = &slots[start];
+        first_count = std::min(available, slots.size() - start);
+        second = slots.data();
+        second_count = available - first_count;
+        return available;
+    }
+
+    void release(size_t count) {
+        read_index.store(read_index.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> slots;
+    const uint64_t mask;
+    alignas(64) std::atomic<uint64_t> write_index{0};   // Productor
+    alignas(64) std::atomic<uint64_t> read_index{0};    // Consumidor
+    alignas(64) std::atomic<uint64_t> dropped{0};       // Productor
+};
+
+/**
+ * Escritor de run.bin: el hilo de recepción solo copia registros al ring; un hilo en segundo plano
+ * los vuelca cada DRAIN_INTERVAL_MS con fwrite sobre un buffer de archivo grande.
+ */
+class BinarySessionWriter {
+public:
+    static constexpr size_t RING_CAPACITY = 1 << 16;          // ~10 MB: > 60 s a 800 hits/s sin drenar
+    static constexpr size_t FILE_BUFFER_SIZE = 4 << 20;       // 4 MB
+    static constexpr int DRAIN_INTERVAL_MS = 10;
+
+    BinarySessionWriter() : ring(RING_CAPACITY), file_buffer(FILE_BUFFER_SIZE) {}
+    ~BinarySessionWriter() { close(); }
+
+    bool open(const std::string& path, const std::string& session_id) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        std::setvbuf(file, file_buffer.data(), _IOFBF, file_buffer.size());
+
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, SESSION_FILE_MAGIC, sizeof(header.magic));
+        header.version = SessionFileHeader::VERSION;
+        header.record_size = sizeof(EventRecord);
+        copyFixed(header.session_id, sizeof(header.session_id), session_id.c_str());
+        std::fwrite(&header, sizeof(header), 1, file);
+
+        running.store(true, std::memory_order_release);
+        writer_thread = std::thread([this] { writerLoop(); });
+        return true;
+    }
+
+    /** Wall clock del timestamp 0 (se escribe en la cabecera al cerrar) */
+    void setStartWallNs(int64_t wall_ns) { header.start_wall_ns = wall_ns; }
+
+    /** Hilo de recepción: copia al ring (sin syscalls ni allocations) */
+    bool push(const EventRecord& rec) { return ring.push(rec); }
+
+    /** Drena lo pendiente, completa la cabecera y cierra. Devuelve registros escritos. */
+    uint64_t close() {
+        if (!file) {
+            return records_written;
+        }
+        running.store(false, std::memory_order_release);
+        if (writer_thread.joinable()) {
+            writer_thread.join();
+        }
+        header.record_count = records_written;
+        header.dropped_count = ring.droppedCount();
+        std::fflush(file);
+        std::fseek(file, 0, SEEK_SET);
+        std::fwrite(&header, sizeof(header), 1, file);
+        std::fclose(file);
+        file = nullptr;
+        return records_written;
+    }
+
+    uint64_t droppedCount() const { return ring.droppedCount(); }
+
+private:
+    SpscRing<EventRecord> ring;
+    std::vector<char> file_buffer;
+    std::FILE* file = nullptr;
+    SessionFileHeader header{};
+    std::thread writer_thread;
+    std::atomic<bool> running{false};
+    uint64_t records_written = 0;   // Solo el writer (leído tras join)
+
+    void writerLoop() {
+        for (;;) {
+            bool keep_running = running.load(std::memory_order_acquire);
+            const EventRecord* first;
+            const EventRecord* second;
+            size_t first_count, second_count;
+            size_t n = ring.peek(first, first_count, second, second_count);
+            if (n > 0) {
+                std::fwrite(first, sizeof(EventRecord), first_count, file);
+                if (second_count > 0) {
+                    std::fwrite(second, sizeof(EventRecord), second_count, file);
+                }
+                ring.release(n);
+                records_written += n;
+                continue;
+            }
+            if (!keep_running) {
+                break; // Ring vacío tras la orden de cerrar
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+        }
+    }
+};
+
+/**
+ * Abre run.bin y valida la cabecera; deja el archivo posicionado en el primer registro (nullptr si falla)
+ */
+static std::FILE* openSessionFile(const std::string& bin_path, SessionFileHeader& header) {
+    std::FILE* in = std::fopen(bin_path.c_str(), "rb");
+    if (!in) {
+        std::cerr << "Error: No se pudo abrir " << bin_path << std::endl;
+        return nullptr;
+    }
+    if (std::fread(&header, sizeof(header), 1, in) != 1
+        || std::memcmp(header.magic, SESSION_FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SessionFileHeader::VERSION
+        || header.record_size != sizeof(EventRecord)) {
+        std::cerr << "Error: " << bin_path << " no es un run.bin compatible" << std::endl;
+        std::fclose(in);
+        return nullptr;
+    }
+    return in;
+}
+
+/**
+ * Conversor offline run.bin → run.ndjson
+ */
+static bool convertSessionToNdjson(const std::string& bin_path, const std::string& ndjson_path) {
+    SessionFileHeader header;
+    std::FILE* in = openSessionFile(bin_path, header);
+    if (!in) {
+        return false;
+    }
+    std::FILE* out = std::fopen(ndjson_path.c_str(), "w");
+    if (!out) {
+        std::cerr << "Error: No se pudo abrir " << ndjson_path << std::endl;
+        std::fclose(in);
+        return false;
+    }
+
+    // record_count == 0: sesión interrumpida, se leen todos los registros completos
+    uint64_t count = 0;
+    uint64_t truncated = 0;
+    EventRecord rec;
+    while ((header.record_count == 0 || count < header.record_count)
+           && std::fread(&rec, sizeof(rec), 1, in) == 1) {
+        rec.address[EventRecord::ADDRESS_SIZE - 1] = '\0';
+        if (rec.num_args > EventRecord::MAX_ARGS) rec.num_args = EventRecord::MAX_ARGS;
+        for (int k = 0; k < rec.num_args; k++) {
+            if ((rec.types[k] == 's' || rec.types[k] == 'S')
+                && rec.values[k].text.offset + rec.values[k].text.length > EventRecord::TEXT_SIZE) {
+                rec.types[k] = 'N';
+            }
+        }
+        if (rec.flags & EventRecord::FLAG_TRUNCATED) truncated++;
+        writeNdjsonLine(out, rec);
+        count++;
+    }
+    std::fclose(in);
+    bool ok = std::fclose(out) == 0;
+
+    std::cout << "Convertidos " << count << " eventos → " << ndjson_path;
+    if (header.dropped_count > 0) std::cout << " (" << header.dropped_count << " descartados en captura)";
+    if (truncated > 0) std::cout << " (" << truncated << " recortados)";
+    std::cout << std::endl;
+    return ok;
+}
+
+/**
+ * Muestra de latencia hit → sonido reportada por PAS en /latency
+ */
+struct LatencySample {
+    double latency_ms;      // Detección en ISTR → salida estimada del DAC
+    double to_render_ms;    // Detección → callback de audio que disparó la voz
+    float dsp_load;         // Carga del bloque (0..1)
+    int active_voices;
+    int hits_per_sec;       // /hit recibidos por PAS en el segundo anterior
+    int flags;              // 1 = snapshot fusionado, 2 = coalescido
+};
+
+/**
+ * Percentil por rango más cercano sobre un vector ordenado
+ */
+static double nearestRankPercentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/**
+ * Informe offline de latencia hit → sonido: empareja /hit con sonda (t_us) y /latency de PAS
+ * y agrupa por nivel de carga (hits/s). Ver CALIB_SPEC.md (Latencia end-to-end).
+ */
+static bool reportLatency(const std::string& bin_path, int step, const std::string& csv_path) {
+    SessionFileHeader header;
+    std::FILE* in = openSessionFile(bin_path, header);
+    if (!in) {
+        return false;
+    }
+
+    // /hit con t_us por sonda (varios hits pueden compartir microsegundo)
+    std::unordered_map<uint32_t, int> probed_hits;
+    uint64_t num_probed_hits = 0;
+    std::vector<LatencySample> samples;
+    uint64_t unmatched_latency = 0;
+    std::vector<uint32_t> latency_keys;
+
+    uint64_t count = 0;
+    EventRecord rec;
+    while ((header.record_count == 0 || count < header.record_count)
+           && std::fread(&rec, sizeof(rec), 1, in) == 1) {
+        count++;
+        rec.address[EventRecord::ADDRESS_SIZE - 1] = '\0';
+        if (std::strcmp(rec.address, "/hit") == 0) {
+            if (rec.num_args == 8 && rec.types[7] == 'i') {
+                probed_hits[(uint32_t)rec.values[7].i]++;
+                num_probed_hits++;
+            }
+        } else if (std::strcmp(rec.address, "/latency") == 0) {
+            // /latency tUs toRenderUs outputUs triggerSample activeVoices dspLoad hitsPerSec flags
+            if (rec.num_args != 8 || std::memcmp(rec.types, "iiiiifii", 8) != 0) {
+                continue;
+            }
+            LatencySample s;
+            s.to_render_ms = (double)rec.values[1].i / 1000.0;
+            s.latency_ms = (double)(rec.values[1].i + rec.values[2].i) / 1000.0;
+            s.active_voices = (int)rec.values[4].i;
+            s.dsp_load = (float)rec.values[5].d;
+            s.hits_per_sec = (int)rec.values[6].i;
+            s.flags = (int)rec.values[7].i;
+            samples.push_back(s);
+            latency_keys.push_back((uint32_t)rec.values[0].i);
+        }
+    }
+    std::fclose(in);
+
+    // Emparejar después de leer todo: /latency llega después de su /hit, pero el orden entre fuentes no está garantizado
+    uint64_t matched = 0;
+    for (uint32_t key : latency_keys) {
+        auto it = probed_hits.find(key);
+        if (it != probed_hits.end() && it->second > 0) {
+            it->second--;
+            matched++;
+        } else {
+            unmatched_latency++;
+        }
+    }
+
+    if (samples.empty()) {
+        std::cerr << "Sin /latency en " << bin_path << " (¿latency_probe activo en ISTR y PAS enviando a este puerto?)" << std::endl;
+        return false;
+    }
+
+    std::FILE* csv = nullptr;
+    if (!csv_path.empty()) {
+        csv = std::fopen(csv_path.c_str(), "w");
+        if (!csv) {
+            std::cerr << "Error: No se pudo abrir " << csv_path << std::endl;
+            return false;
+        }
+        std::fprintf(csv, "hits_per_sec_bucket,n,p50_ms,p99_ms,max_ms,to_render_p50_ms,mean_dsp_load,mean_voices\n");
+    }
+
+    // Buckets de carga [k·step, (k+1)·step) y fila total (-1)
+    std::map<int, std::vector<const LatencySample*>> buckets;
+    for (const auto& s : samples) {
+        buckets[(std::max(0, s.hits_per_sec) / step) * step].push_back(&s);
+        buckets[-1].push_back(&s);
+    }
+
+    std::cout << "Sondas: " << num_probed_hits << " /hit con t_us, " << samples.size() << " /latency ("
+              << matched << " emparejadas, " << unmatched_latency << " sin /hit registrado)" << std::endl;
+    if (num_probed_hits > matched) {
+        std::cout << "  " << (num_probed_hits - matched)
+                  << " /hit sin sonido propio (fusionados o coalescidos con una sonda anterior, o descartados)" << std::endl;
+    }
+    std::cout << std::endl;
+    std::cout << std::setw(10) << "hits/s" << std::setw(8) << "n"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+              << std::setw(12) << "render p50" << std::setw(8) << "dsp" << std::setw(8) << "voces" << std::endl;
+
+    auto printRow = [&](int bucket, const std::vector<const LatencySample*>& group) {
+        std::vector<double> latency, to_render;
+        double load_sum = 0.0;
+        double voices_sum = 0.0;
+        for (const auto* s : group) {
+            latency.push_back(s->latency_ms);
+            to_render.push_back(s->to_render_ms);
+            load_sum += s->dsp_load;
+            voices_sum += s->active_voices;
+        }
+        std::sort(latency.begin(), latency.end());
+        std::sort(to_render.begin(), to_render.end());
+        double n = (double)group.size();
+        double p50 = nearestRankPercentile(latency, 50.0);
+        double p99 = nearestRankPercentile(latency, 99.0);
+        double render_p50 = nearestRankPercentile(to_render, 50.0);
+
+        std::string label = bucket < 0 ? std::string("total") : std::to_string(bucket) + "+";
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(10) << label << std::setw(8) << group.size()
+                  << std::setw(10) << p50 << std::setw(10) << p99 << std::setw(10) << latency.back()
+                  << std::setw(12) << render_p50
+                  << std::setw(8) << load_sum / n << std::setw(8) << std::setprecision(1) << voices_sum / n
+                  << std::endl;
+        if (csv) {
+            std::fprintf(csv, "%s,%zu,%.3f,%.3f,%.3f,%.3f,%.4f,%.2f\n", bucket < 0 ? "total" : std::to_string(bucket).c_str(),
+                         group.size(), p50, p99, latency.back(), render_p50, load_sum / n, voices_sum / n);
+        }
+    };
+    for (const auto& entry : buckets) {
+        if (entry.first >= 0) {
+            printRow(entry.first, entry.second);
+        }
+    }
+    printRow(-1, buckets[-1]);
+
+    bool ok = true;
+    if (csv) {
+        ok = std::fclose(csv) == 0;
+        std::cout << "CSV → " << csv_path << std::endl;
+    }
+    return ok;
+}
+
+/**
+ * Enteros little-endian para cabeceras WAV
+ */
+static void putLE16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void putLE32(uint8_t* p, uint32_t v) {
+    for (int k = 0; k < 4; k++) p[k] = (uint8_t)(v >> (8 * k));
+}
+
+static uint16_t getLE16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t getLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * Lee un WAV (PCM 16/24/32 bits o float 32) a float intercalado. Devuelve false si el formato no es compatible.
+ */
+static bool readWavFile(const std::string& path, std::vector<float>& samples, double& sample_rate, int& channels) {
+    std::ifstream in(path, std::ios::binary);
+    uint8_t riff[12];
+    if (!in.read((char*)riff, sizeof(riff)) || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    uint16_t format = 0, bits = 0;
+    channels = 0;
+    uint8_t chunk[8];
+    while (in.read((char*)chunk, sizeof(chunk))) {
+        uint32_t size = getLE32(chunk + 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            std::vector<uint8_t> fmt(size);
+            if (!in.read((char*)fmt.data(), size)) return false;
+            format = getLE16(&fmt[0]);
+            channels = getLE16(&fmt[2]);
+            sample_rate = getLE32(&fmt[4]);
+            bits = getLE16(&fmt[14]);
+            if (format == 0xFFFE && size >= 26) format = getLE16(&fmt[24]); // WAVE_FORMAT_EXTENSIBLE
+            if (size & 1) in.seekg(1, std::ios::cur);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+            bool ieee = format == 3 && bits == 32;
+            if (channels <= 0 || sample_rate <= 0 || !(pcm || ieee)) return false;
+            std::vector<uint8_t> data(size);
+            in.read((char*)data.data(), size);
+            size_t bytes = bits / 8;
+            size_t count = (size_t)in.gcount() / bytes / channels * channels; // Frames completos
+            samples.resize(count);
+            for (size_t k = 0; k < count; k++) {
+                const uint8_t* p = &data[k * bytes];
+                if (ieee) {
+                    uint32_t u = getLE32(p);
+                    std::memcpy(&samples[k], &u, sizeof(float));
+                } else if (bits == 16) {
+                    samples[k] = (float)(int16_t)getLE16(p) / 32768.0f;
+                } else if (bits == 24) {
+                    int32_t v = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+                    samples[k] = (float)v / 8388608.0f;
+                } else {
+                    samples[k] = (float)((double)(int32_t)getLE32(p) / 2147483648.0);
+                }
+            }
+            return true;
+        } else {
+            in.seekg(size + (size & 1), std::ios::cur);
+        }
+    }
+    return false;
+}
+
+/**
+ * Fuente de audio local: entrega bloques float intercalados desde su propio hilo (el del driver).
+ * El callback no debe bloquear; la fuente no espera al consumidor.
+ */
+class AudioSource {
+public:
+    using Callback = std::function<void(const float* interleaved, int frames)>;
+
+    virtual ~AudioSource() = default;
+    virtual double sampleRate() const = 0;
+    virtual int numChannels() const = 0;
+    virtual bool start(Callback callback) = 0;
+    virtual void stop() = 0;
+};
+
+/**
+ * Sustituto de una interfaz de audio para pruebas: reproduce un WAV en bloques de BLOCK_FRAMES a ritmo
+ * de tiempo real (como un driver, cada callback llega cuando su bloque ya está completo) y luego
+ * entrega silencio hasta stop().
+ */
+class FileAudioSource : public AudioSource {
+public:
+    static constexpr int BLOCK_FRAMES = 256;
+
+    ~FileAudioSource() override { stop(); }
+
+    bool load(const std::string& path) { return readWavFile(path, samples, rate, channels); }
+
+    double sampleRate() const override { return rate; }
+    int numChannels() const override { return channels; }
+
+    bool start(Callback new_callback) override {
+        if (channels <= 0 || source_thread.joinable()) {
+            return false;
+        }
+        callback = std::move(new_callback);
+        running.store(true, std::memory_order_release);
+        source_thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() override {
+        running.store(false, std::memory_order_release);
+        if (source_thread.joinable()) {
+            source_thread.join();
+        }
+    }
+
+private:
+    std::vector<float> samples;
+    double rate = 48000.0;
+    int channels = 0;
+    Callback callback;
+    std::thread source_thread;
+    std::atomic<bool> running{false};
+
+    void run() {
+        std::vector<float> block((size_t)BLOCK_FRAMES * channels);
+        size_t total_frames = samples.size() / channels;
+        size_t position = 0;
+        int64_t delivered = 0;
+        auto start_time = std::chrono::steady_clock::now();
+        while (running.load(std::memory_order_acquire)) {
+            // Plazo desde el total de frames entregados: sin deriva acumulada por redondeo del período
+            delivered += BLOCK_FRAMES;
+            std::this_thread::sleep_until(start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((double)delivered / rate)));
+
+            size_t n = position < total_frames ? std::min((size_t)BLOCK_FRAMES, total_frames - position) : 0;
+            std::copy(samples.begin() + position * channels, samples.begin() + (position + n) * channels, block.begin());
+            std::fill(block.begin() + n * channels, block.end(), 0.0f);
+            position += n;
+            callback(block.data(), BLOCK_FRAMES);
+        }
+    }
+};
+
+/**
+ * Bloque del ring de captura: frames con su posición en el reloj del dispositivo y un punto de
+ * sincronización con el reloj de sesión (steady_clock, el mismo de t_ns en run.bin).
+ */
+struct AudioBlock {
+    static constexpr int MAX_FRAMES = 1024;
+    static constexpr int MAX_CHANNELS = 2;     // Mono o estéreo (CALIB_SPEC.md)
+
+    int64_t first_frame;        // Frames del dispositivo desde el primer callback
+    int64_t sync_frame;         // Frame siguiente al último del callback más reciente que escribió aquí
+    int64_t sync_ns;            // steady_clock desde el inicio de sesión al entrar ese callback
+    int32_t frames;
+    float samples[MAX_FRAMES * MAX_CHANNELS];
+};
+
+/**
+ * Captura de audio.wav. El callback de la fuente copia frames al bloque abierto del ring (sin locks,
+ * allocations ni syscalls); un hilo en segundo plano los escribe como WAV y reescribe los tamaños de la
+ * cabecera cada HEADER_UPDATE_SECONDS, así una sesión interrumpida deja un WAV legible.
+ *
+ * Reloj común: el sample 0 de audio.wav es timestamp 0 de run.ndjson. El primer bloque se ubica en el
+ * reloj de sesión con su punto de sincronización (se antepone silencio o se recortan frames) y los
+ * bloques descartados con el ring lleno se rellenan con silencio para no desplazar el resto.
+ * audio_sync.csv guarda un par (frame, t_ns) por segundo para medir la deriva del reloj de la interfaz.
+ */
+class AudioCaptureWriter {
+public:
+    static constexpr size_t RING_CAPACITY = 512;              // 512 × 1024 frames: ~10 s a 48 kHz
+    static constexpr size_t FILE_BUFFER_SIZE = 1 << 20;       // 1 MB
+    static constexpr int DRAIN_INTERVAL_MS = 10;
+    static constexpr double HEADER_UPDATE_SECONDS = 1.0;
+    static constexpr int64_t SYNC_INTERVAL_NS = 1000000000;
+
+    AudioCaptureWriter()
+        : ring(RING_CAPACITY), file_buffer(FILE_BUFFER_SIZE),
+          pcm((size_t)AudioBlock::MAX_FRAMES * AudioBlock::MAX_CHANNELS * sizeof(float)) {}
+    ~AudioCaptureWriter() { close(); }
+
+    /** bits_per_sample: 16 o 24 (PCM entero) o 32 (float) */
+    bool open(const std::string& wav_path, const std::string& sync_path, double rate, int device_channels, int bits_per_sample) {
+        if (rate <= 0 || device_channels <= 0 || !(bits_per_sample == 16 || bits_per_sample == 24 || bits_per_sample == 32)) {
+            return false;
+        }
+        file = std::fopen(wav_path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        std::setvbuf(file, file_buffer.data(), _IOFBF, file_buffer.size());
+        sync_file = std::fopen(sync_path.c_str(), "w");
+        if (sync_file) {
+            std::fputs("frame,t_ns\n", sync_file);
+        }
+
+        sample_rate = rate;
+        source_channels = device_channels;
+        channels = std::min(device_channels, AudioBlock::MAX_CHANNELS);
+        bits = bits_per_sample;
+        frame_bytes = channels * (bits / 8);
+        header_interval = std::max<int64_t>(1, (int64_t)(HEADER_UPDATE_SECONDS * sample_rate));
+
+        uint8_t header[44];
+        std::memcpy(header, "RIFF", 4);
+        putLE32(header + 4, 36);
+        std::memcpy(header + 8, "WAVEfmt ", 8);
+        putLE32(header + 16, 16);
+        putLE16(header + 20, bits == 32 ? 3 : 1);  // WAVE_FORMAT_IEEE_FLOAT / WAVE_FORMAT_PCM
+        putLE16(header + 22, (uint16_t)channels);
+        putLE32(header + 24, (uint32_t)std::lround(sample_rate));
+        putLE32(header + 28, (uint32_t)std::lround(sample_rate) * (uint32_t)frame_bytes);
+        putLE16(header + 32, (uint16_t)frame_bytes);
+        putLE16(header + 34, (uint16_t)bits);
+        std::memcpy(header + 36, "data", 4);
+        putLE32(header + 40, 0);
+        std::fwrite(header, sizeof(header), 1, file);
+        return true;
+    }
+
+    /** Fija el reloj de sesión y arranca el writer (antes de arrancar la fuente) */
+    void start(std::chrono::steady_clock::time_point session_start) {
+        start_time = session_start;
+        running.store(true, std::memory_order_release);
+        writer_thread = std::thread([this] { writerLoop(); });
+    }
+
+    /** Callback de la fuente (hilo de audio): copia al bloque abierto; con el ring lleno descarta y cuenta */
+    void push(const float* interleaved, int frames) {
+        int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+        int64_t end_frame = device_frame + frames;
+
+        while (frames > 0) {
+            if (!open_block) {
+                open_block = ring.beginWrite();
+                if (!open_block) {
+                    dropped_frames.store(dropped_frames.load(std::memory_order_relaxed) + (uint64_t)frames,
+                                         std::memory_order_relaxed);
+                    device_frame += frames;
+                    return;
+                }
+                open_block->first_frame = device_frame;
+                open_block->frames = 0;
+            }
+            int n = std::min(frames, AudioBlock::MAX_FRAMES - open_block->frames);
+            float* dst = open_block->samples + (size_t)open_block->frames * channels;
+            if (source_channels == channels) {
+                std::memcpy(dst, interleaved, (size_t)n * channels * sizeof(float));
+            } else {
+                for (int f = 0; f < n; f++) {
+                    for (int c = 0; c < channels; c++) dst[f * channels + c] = interleaved[f * source_channels + c];
+                }
+            }
+            open_block->frames += n;
+            open_block->sync_frame = end_frame;
+            open_block->sync_ns = now_ns;
+            interleaved += (size_t)n * source_channels;
+            frames -= n;
+            device_frame += n;
+
+            if (open_block->frames == AudioBlock::MAX_FRAMES) {
+                ring.endWrite();
+                open_block = nullptr;
+            }
+        }
+    }
+
+    /** Con la fuente ya detenida: publica el bloque parcial, drena, completa la cabecera y cierra */
+    void close() {
+        if (!file) {
+            return;
+        }
+        if (open_block) {
+            ring.endWrite();
+            open_block = nullptr;
+        }
+        running.store(false, std::memory_order_release);
+        if (writer_thread.joinable()) {
+            writer_thread.join();
+        }
+        updateHeader();
+        std::fclose(file);
+        file = nullptr;
+        if (sync_file) {
+            std::fclose(sync_file);
+            sync_file = nullptr;
+        }
+    }
+
+    double sampleRate() const { return sample_rate; }
+    uint64_t framesWritten() const { return (uint64_t)frames_written; }
+    uint64_t droppedFrames() const { return dropped_frames.load(std::memory_order_relaxed); }
+
+private:
+    SpscRing<AudioBlock> ring;
+    std::vector<char> file_buffer;
+    std::vector<uint8_t> pcm;           // Conversión float → PCM (writer)
+    std::FILE* file = nullptr;
+    std::FILE* sync_file = nullptr;
+    std::thread writer_thread;
+    std::atomic<bool> running{false};
+    std::chrono::steady_clock::time_point start_time;
+    double sample_rate = 48000.0;
+    int source_channels = 1;
+    int channels = 1;
+    int bits = 24;
+    int frame_bytes = 3;
+
+    // Productor (hilo de audio)
+    AudioBlock* open_block = nullptr;
+    int64_t device_frame = 0;
+    std::atomic<uint64_t> dropped_frames{0};
+
+    // Consumidor (writer; leídos tras join)
+    bool aligned = false;
+    int64_t offset_frames = 0;          // Frame de audio.wav = frame del dispositivo + offset
+    int64_t frames_written = 0;
+    int64_t header_interval = 48000;
+    int64_t next_header_update = 0;
+    int64_t next_sync_ns = 0;
+
+    void writerLoop() {
+        next_header_update = header_interval;
+        for (;;) {
+            bool keep_running = running.load(std::memory_order_acquire);
+            const AudioBlock* first;
+            const AudioBlock* second;
+            size_t first_count, second_count;
+            size_t n = ring.peek(first, first_count, second, second_count);
+            if (n > 0) {
+                for (size_t k = 0; k < first_count; k++) writeBlock(first[k]);
+                for (size_t k = 0; k < second_count; k++) writeBlock(second[k]);
+                ring.release(n);
+                if (frames_written >= next_header_update) {
+                    updateHeader();
+                    next_header_update = frames_written + header_interval;
+                }
+                continue;
+            }
+            if (!keep_running) {
+                break; // Ring vacío tras la orden de cerrar
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+        }
+    }
+
+    void writeBlock(const AudioBlock& block) {
+        if (!aligned) {
+            // sync_ns ≈ instante de sync_frame: el callback llega al completarse su bloque
+            double first_ns = (double)block.sync_ns - (double)(block.sync_frame - block.first_frame) * 1e9 / sample_rate;
+            offset_frames = std::llround(first_ns * 1e-9 * sample_rate) - block.first_frame;
+            aligned = true;
+        }
+        int64_t out_frame = block.first_frame + offset_frames;
+        if (out_frame > frames_written) {
+            writeSilence(out_frame - frames_written); // Antes del primer bloque o bloques descartados
+        }
+        int skip = (int)std::min<int64_t>(std::max<int64_t>(frames_written - out_frame, 0), block.frames);
+        writeFrames(block.samples + (size_t)skip * channels, block.frames - skip);
+
+        if (sync_file && block.sync_ns >= next_sync_ns) {
+            std::fprintf(sync_file, "%lld,%lld\n", (long long)(block.sync_frame + offset_frames), (long long)block.sync_ns);
+            next_sync_ns = block.sync_ns + SYNC_INTERVAL_NS;
+        }
+    }
+
+    void writeFrames(const float* src, int frames) {
+        size_t count = (size_t)frames * channels;
+        uint8_t* out = pcm.data();
+        for (size_t k = 0; k < count; k++) {
+            float x = src[k];
+            if (bits == 32) {
+                uint32_t u;
+                std::memcpy(&u, &x, sizeof(u));
+                putLE32(out, u);
+                out += 4;
+                continue;
+            }
+            x = std::isfinite(x) ? std::min(1.0f, std::max(-1.0f, x)) : 0.0f;
+            if (bits == 16) {
+                putLE16(out, (uint16_t)(int16_t)std::min(32767L, std::lrint(x * 32768.0f)));
+                out += 2;
+            } else {
+                uint32_t v = (uint32_t)(int32_t)std::min(8388607L, std::lrint(x * 8388608.0f));
+                out[0] = (uint8_t)v;
+                out[1] = (uint8_t)(v >> 8);
+                out[2] = (uint8_t)(v >> 16);
+                out += 3;
+            }
+        }
+        std::fwrite(pcm.data(), 1, (size_t)(out - pcm.data()), file);
+        frames_written += frames;
+    }
+
+    void writeSilence(int64_t frames) {
+        std::fill(pcm.begin(), pcm.end(), 0); // Cero en PCM entero y en float
+        while (frames > 0) {
+            int n = (int)std::min<int64_t>(frames, AudioBlock::MAX_FRAMES);
+            std::fwrite(pcm.data(), 1, (size_t)n * frame_bytes, file);
+            frames_written += n;
+            frames -= n;
+        }
+    }
+
+    /** Tamaños RIFF y data según lo escrito (el límite de 4 GB de WAV son ~4 h en estéreo 24 bits a 48 kHz) */
+    void updateHeader() {
+        uint64_t data_bytes = std::min<uint64_t>((uint64_t)frames_written * frame_bytes, 0xFFFFFFFFull - 36);
+        uint8_t size[4];
+        std::fflush(file);
+        std::fseek(file, 4, SEEK_SET);
+        putLE32(size, (uint32_t)(36 + data_bytes));
+        std::fwrite(size, sizeof(size), 1, file);
+        std::fseek(file, 40, SEEK_SET);
+        putLE32(size, (uint32_t)data_bytes);
+        std::fwrite(size, sizeof(size), 1, file);
+        std::fseek(file, 0, SEEK_END);
+        std::fflush(file);
+    }
+};
+
 /**
  * Clase principal para captura y registro de datos
  */
 class CalibRecorder {
+public:
+    /**
+     * Binary (default): registros fijos a un ring, volcados a run.bin por un hilo en segundo plano y
+     * convertidos a run.ndjson al detener la sesión. Ndjson: una línea por evento en el hilo de recepción
+     * (solo para depuración a baja tasa).
+     */
+    enum class RecordingMode { Binary, Ndjson };
+
 private:
-    bool is_recording;
+    std::atomic<bool> is_recording;  // Escrito por el hilo de control, leído por el de recepción
+    std::atomic<int> events_in_flight{0}; // recordOSCEvent en curso: stopSession espera a 0 antes de cerrar
     std::string session_id;
     std::string runs_dir;
-    std::ofstream ndjson_file;
+    std::string session_dir;
+    RecordingMode mode;
+    bool convert_on_stop;           // Binary: generar run.ndjson al detener
+    std::FILE* ndjson_file;
+    std::unique_ptr<BinarySessionWriter> binary_writer;
     std::chrono::steady_clock::time_point session_start;
     
-    // TODO: Agregar miembros para captura de audio
-    // AudioRecorder* audio_recorder;
+    AudioSource* audio_source;      // Opcional, sin ownership (JACK/ALSA o FileAudioSource)
+    int audio_bits;
+    std::unique_ptr<AudioCaptureWriter> audio_writer;
     
 public:
-    CalibRecorder() : is_recording(false) {
-        // TODO: Inicializar directorio runs/
+    CalibRecorder() : is_recording(false), mode(RecordingMode::Binary), convert_on_stop(true), ndjson_file(nullptr),
+                      audio_source(nullptr), audio_bits(24) {
         runs_dir = "runs/";
     }
+
+    /** Modo de registro de la próxima sesión */
+    void setRecordingMode(RecordingMode new_mode, bool convert_binary_on_stop = true) {
+        mode = new_mode;
+        convert_on_stop = convert_binary_on_stop;
+    }
+
+    /** Fuente de audio.wav de la próxima sesión (nullptr: sesión sin audio). bits: 16, 24 o 32 (float). */
+    void setAudioSource(AudioSource* source, int bits_per_sample = 24) {
+        audio_source = source;
+        audio_bits = bits_per_sample;
+    }
     
     /**
      * Iniciar sesión de calibración
@@ -77,21 +1104,53 @@ public:
         }
         
         // Crear directorio de sesión
-        std::string session_dir = runs_dir + session_id + "/";
-        // TODO: Crear directorio si no existe
-        
-        // Abrir archivo NDJSON
-        std::string ndjson_path = session_dir + "run.ndjson";
-        ndjson_file.open(ndjson_path);
-        if (!ndjson_file.is_open()) {
-            std::cerr << "Error: No se pudo abrir " << ndjson_path << std::endl;
-            return false;
+        session_dir = runs_dir + session_id + "/";
+        std::error_code ec;
+        std::filesystem::create_directories(session_dir, ec);
+        
+        if (mode == RecordingMode::Binary) {
+            std::string bin_path = session_dir + "run.bin";
+            binary_writer = std::make_unique<BinarySessionWriter>();
+            if (!binary_writer->open(bin_path, session_id)) {
+                std::cerr << "Error: No se pudo abrir " << bin_path << std::endl;
+                binary_writer.reset();
+                return false;
+            }
+        } else {
+            // Abrir archivo NDJSON
+            std::string ndjson_path = session_dir + "run.ndjson";
+            ndjson_file = std::fopen(ndjson_path.c_str(), "w");
+            if (!ndjson_file) {
+                std::cerr << "Error: No se pudo abrir " << ndjson_path << std::endl;
+                return false;
+            }
         }
         
-        // Iniciar captura de audio
-        // TODO: Inicializar audio_recorder
+        // Abrir captura de audio (la fuente arranca con el reloj de sesión ya fijado)
+        if (audio_source) {
+            audio_writer = std::make_unique<AudioCaptureWriter>();
+            if (!audio_writer->open(session_dir + "audio.wav", session_dir + "audio_sync.csv",
+                                    audio_source->sampleRate(), audio_source->numChannels(), audio_bits)) {
+                std::cerr << "Error: No se pudo abrir audio.wav; sesión sin audio" << std::endl;
+                audio_writer.reset();
+            }
+        }
         
         session_start = std::chrono::steady_clock::now();
+        if (binary_writer) {
+            binary_writer->setStartWallNs(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+        
+        // Iniciar captura de audio: el callback solo copia al ring del writer
+        if (audio_writer) {
+            audio_writer->start(session_start);
+            AudioCaptureWriter* writer = audio_writer.get();
+            if (!audio_source->start([writer](const float* data, int frames) { writer->push(data, frames); })) {
+                std::cerr << "Error: No se pudo iniciar la fuente de audio; sesión sin audio" << std::endl;
+                audio_writer.reset();
+            }
+        }
         is_recording = true;
         
         std::cout << "Sesión iniciada: " << session_id << std::endl;
@@ -106,67 +1165,265 @@ public:
             std::cerr << "Error: No hay sesión en curso" << std::endl;
             return false;
         }
+        is_recording = false;
         
-        // Detener captura de audio
-        // TODO: Finalizar audio_recorder y guardar audio.wav
+        // Un recordOSCEvent que ya pasó el chequeo puede estar dentro de push(): esperar a que salga
+        // antes de cerrar el writer (se cuenta antes de leer is_recording, ambos seq_cst)
+        while (events_in_flight.load() > 0) {
+            std::this_thread::yield();
+        }
         
-        // Cerrar archivo NDJSON
-        if (ndjson_file.is_open()) {
-            ndjson_file.close();
+        // Detener captura de audio: primero la fuente (sin más callbacks), luego el writer
+        if (audio_writer) {
+            audio_source->stop();
+            audio_writer->close();
+            std::cout << "Audio registrado: " << (double)audio_writer->framesWritten() / audio_writer->sampleRate() << " s";
+            if (audio_writer->droppedFrames() > 0) {
+                std::cout << " (" << audio_writer->droppedFrames() << " frames descartados: ring lleno, rellenados con silencio)";
+            }
+            std::cout << std::endl;
+            audio_writer.reset();
+        }
+        
+        // Cerrar registro de eventos; la conversión a NDJSON ocurre ya fuera de la captura
+        if (binary_writer) {
+            uint64_t written = binary_writer->close();
+            uint64_t dropped = binary_writer->droppedCount();
+            binary_writer.reset();
+            std::cout << "Eventos registrados: " << written;
+            if (dropped > 0) std::cout << " (" << dropped << " descartados: ring lleno)";
+            std::cout << std::endl;
+            if (convert_on_stop) {
+                convertSessionToNdjson(session_dir + "run.bin", session_dir + "run.ndjson");
+            }
+        }
+        if (ndjson_file) {
+            std::fclose(ndjson_file);
+            ndjson_file = nullptr;
         }
         
         // Generar meta.json
         // TODO: Escribir meta.json con metadatos de sesión
         
-        is_recording = false;
         std::cout << "Sesión finalizada: " << session_id << std::endl;
         return true;
     }
     
     /**
-     * Registrar evento OSC
+     * Registrar evento OSC (hilo de recepción). En modo Binary solo lee dos relojes y copia un
+     * registro de tamaño fijo al ring: sin formateo, allocations ni syscalls por evento.
      */
-    void recordOSCEvent(const std::string& address, const std::vector<std::string>& args) {
+    void recordOSCEvent(const char* address, const char* types, const OSCArgValue* argv, int argc) {
+        events_in_flight.fetch_add(1);
         if (!is_recording) {
+            events_in_flight.fetch_sub(1, std::memory_order_release);
             return;
         }
         
-        // Calcular timestamp relativo
+        // Timestamp relativo (steady) y wall clock (UTC), ambos en ns
         auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
-            now - session_start
-        ).count();
-        double timestamp = elapsed / 1000000.0;
-        
-        // Obtener wall clock
-        auto wall_now = std::chrono::system_clock::now();
-        auto wall_time_t = std::chrono::system_clock::to_time_t(wall_now);
-        std::stringstream ss;
-        ss << std::put_time(std::gmtime(&wall_time_t), "%Y-%m-%dT%H:%M:%S");
-        // TODO: Agregar microsegundos al formato ISO 8601
-        
-        // Escribir línea NDJSON
-        // TODO: Serializar correctamente a JSON
-        // Formato: {"timestamp": 0.123, "osc_address": "/hit", "osc_args": [...], "wall_clock": "..."}
-        
-        // Placeholder:
-        ndjson_file << "{\"timestamp\":" << timestamp 
-                    << ",\"osc_address\":\"" << address << "\""
-                    << ",\"osc_args\":[...]"  // TODO: Serializar args correctamente
-                    << ",\"wall_clock\":\"" << ss.str() << "\"}" << std::endl;
+        int64_t t_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - session_start).count();
+        int64_t wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        
+        EventRecord rec;
+        fillEventRecord(rec, t_ns, wall_ns, address, types, argv, argc);
+        
+        if (binary_writer) {
+            binary_writer->push(rec);
+        } else if (ndjson_file) {
+            writeNdjsonLine(ndjson_file, rec); // Buffer de stdio, sin flush forzado por línea
+        }
+        events_in_flight.fetch_sub(1, std::memory_order_release);
     }
     
     /**
-     * Callback para recibir mensajes OSC
+     * Callback para recibir mensajes OSC (hilo de OscUdpReceiver)
      */
-    static void oscCallback(const char* path, const char* types, void* data, void* user_data) {
+    static void oscCallback(const char* path, const char* types, const OSCArgValue* argv, int argc, void* user_data) {
         CalibRecorder* recorder = static_cast<CalibRecorder*>(user_data);
         
-        // TODO: Parsear argumentos OSC según tipos
-        std::vector<std::string> args;
-        
         // Registrar evento
-        recorder->recordOSCEvent(path, args);
+        recorder->recordOSCEvent(path, types, argv, argc);
+    }
+};
+
+/**
+ * Receptor OSC sobre UDP (POSIX, sin dependencias): un hilo lee datagramas, abre bundles y entrega cada
+ * mensaje al handler con la firma de oscCallback. Tags i, f, h, d, s/S, T/F/N/I; un mensaje con otro
+ * tag (blob, etc.) o mal formado se descarta y se cuenta.
+ */
+class OscUdpReceiver {
+public:
+    using Handler = void (*)(const char* path, const char* types, const OSCArgValue* argv, int argc, void* user_data);
+
+    static constexpr int MAX_ARGS = 32;
+    static constexpr size_t MAX_PACKET_SIZE = 65536;
+    static constexpr int SOCKET_BUFFER_SIZE = 4 << 20;     // Absorbe ráfagas de /hit mientras el hilo no lee
+    static constexpr int POLL_TIMEOUT_MS = 100;            // Cadencia para ver la orden de stop()
+    static constexpr int MAX_BUNDLE_DEPTH = 4;
+
+    ~OscUdpReceiver() { stop(); }
+
+    bool start(int port, Handler new_handler, void* new_user_data) {
+        if (receive_thread.joinable()) {
+            return false;
+        }
+        socket_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (socket_fd < 0) {
+            return false;
+        }
+        int buffer_size = SOCKET_BUFFER_SIZE;
+        ::setsockopt(socket_fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+        timeval timeout{};
+        timeout.tv_usec = POLL_TIMEOUT_MS * 1000;
+        ::setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t)port);
+        if (::bind(socket_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(socket_fd);
+            socket_fd = -1;
+            return false;
+        }
+
+        handler = new_handler;
+        user_data = new_user_data;
+        packet.resize(MAX_PACKET_SIZE);
+        running.store(true, std::memory_order_release);
+        receive_thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        running.store(false, std::memory_order_release);
+        if (receive_thread.joinable()) {
+            receive_thread.join();
+        }
+        if (socket_fd >= 0) {
+            ::close(socket_fd);
+            socket_fd = -1;
+        }
+    }
+
+    uint64_t malformedCount() const { return malformed.load(std::memory_order_relaxed); }
+
+private:
+    int socket_fd = -1;
+    Handler handler = nullptr;
+    void* user_data = nullptr;
+    std::vector<char> packet;
+    std::thread receive_thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> malformed{0};
+
+    void run() {
+        while (running.load(std::memory_order_acquire)) {
+            ssize_t n = ::recv(socket_fd, packet.data(), packet.size(), 0);
+            if (n <= 0) {
+                continue; // Timeout (revisar running) o error transitorio
+            }
+            if (!dispatch(packet.data(), (size_t)n, 0)) {
+                malformed.store(malformed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static uint32_t getBE32(const char* p) {
+        const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+        return (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | (uint32_t)b[3];
+    }
+
+    static uint64_t getBE64(const char* p) {
+        return (uint64_t)getBE32(p) << 32 | getBE32(p + 4);
+    }
+
+    /** String OSC terminada en '\0' y alineada a 4 bytes; avanza pos (false si se sale del paquete) */
+    static bool readString(const char* data, size_t size, size_t& pos, const char*& out) {
+        const void* end = pos < size ? std::memchr(data + pos, '\0', size - pos) : nullptr;
+        if (!end) {
+            return false;
+        }
+        out = data + pos;
+        pos = ((size_t)(static_cast<const char*>(end) - data) + 4) & ~(size_t)3;
+        return pos <= size;
+    }
+
+    /** Un mensaje o un bundle (recursivo); false si está mal formado */
+    bool dispatch(const char* data, size_t size, int depth) {
+        if (size >= 16 && std::memcmp(data, "#bundle", 8) == 0) {
+            if (depth >= MAX_BUNDLE_DEPTH) {
+                return false;
+            }
+            size_t pos = 16; // "#bundle\0" + time tag (se ignora: el instante es el de llegada)
+            bool ok = true;
+            while (pos + 4 <= size) {
+                size_t element_size = getBE32(data + pos);
+                pos += 4;
+                if (element_size > size - pos || (element_size & 3) != 0) {
+                    return false;
+                }
+                ok = dispatch(data + pos, element_size, depth + 1) && ok;
+                pos += element_size;
+            }
+            return ok && pos == size;
+        }
+
+        size_t pos = 0;
+        const char* address;
+        const char* type_tags;
+        if (!readString(data, size, pos, address) || address[0] != '/'
+            || !readString(data, size, pos, type_tags) || type_tags[0] != ',') {
+            return false;
+        }
+        const char* types = type_tags + 1;
+        int argc = (int)std::strlen(types);
+        if (argc > MAX_ARGS) {
+            return false;
+        }
+
+        OSCArgValue argv[MAX_ARGS];
+        for (int k = 0; k < argc; k++) {
+            switch (types[k]) {
+                case 'i':
+                case 'f':
+                    if (pos + 4 > size) return false;
+                    if (types[k] == 'i') {
+                        argv[k].i = (int32_t)getBE32(data + pos);
+                    } else {
+                        uint32_t bits = getBE32(data + pos);
+                        std::memcpy(&argv[k].f, &bits, sizeof(bits));
+                    }
+                    pos += 4;
+                    break;
+                case 'h':
+                case 'd':
+                    if (pos + 8 > size) return false;
+                    if (types[k] == 'h') {
+                        argv[k].h = (int64_t)getBE64(data + pos);
+                    } else {
+                        uint64_t bits = getBE64(data + pos);
+                        std::memcpy(&argv[k].d, &bits, sizeof(bits));
+                    }
+                    pos += 8;
+                    break;
+                case 's':
+                case 'S':
+                    if (!readString(data, size, pos, argv[k].s)) return false;
+                    break;
+                case 'T':
+                case 'F':
+                case 'N':
+                case 'I':
+                    break;
+                default:
+                    return false;
+            }
+        }
+        handler(address, types, argv, argc, user_data);
+        return true;
     }
 };
 
@@ -178,22 +1435,92 @@ int main(int argc, char* argv[]) {
     std::cout << "Módulo de Calibración y Validación" << std::endl;
     std::cout << std::endl;
     
-    CalibRecorder recorder;
-    
-    // TODO: Inicializar servidor OSC para recibir mensajes
-    // lo_server_thread server = lo_server_thread_new("9000", oscCallback);
-    // lo_server_thread_add_method(server, NULL, NULL, oscCallback, &recorder);
-    // lo_server_thread_start(server);
-    
+    // Modo análisis: maad-2-calib convert runs/<sesión>/run.bin [run.ndjson]
+    if (argc >= 3 && std::string(argv[1]) == "convert") {
+        std::string bin_path = argv[2];
+        std::string ndjson_path = argc >= 4 ? argv[3]
+            : std::filesystem::path(bin_path).replace_extension(".ndjson").string();
+        return convertSessionToNdjson(bin_path, ndjson_path) ? 0 : 1;
+    }
+
+    // Informe de latencia: maad-2-calib latency runs/<sesión>/run.bin [--step=100] [--csv=latency.csv]
+    if (argc >= 3 && std::string(argv[1]) == "latency") {
+        int step = 100;
+        std::string csv_path;
+        for (int i = 3; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--step=", 0) == 0) {
+                step = std::max(1, std::atoi(arg.c_str() + 7));
+            } else if (arg.rfind("--csv=", 0) == 0) {
+                csv_path = arg.substr(6);
+            }
+        }
+        return reportLatency(argv[2], step, csv_path) ? 0 : 1;
+    }
+
+    // Grabación: maad-2-calib record <segundos> [run_id] [--port=9200] [--ndjson] [--audio-file=<wav>] [--audio-bits=16|24|32]
+    if (argc >= 3 && std::string(argv[1]) == "record") {
+        double seconds = std::atof(argv[2]);
+        if (seconds <= 0.0) {
+            std::cerr << "Error: Duración inválida: " << argv[2] << std::endl;
+            return 1;
+        }
+        std::string run_id = (argc >= 4 && argv[3][0] != '-') ? argv[3] : "";
+
+        CalibRecorder recorder;
+        FileAudioSource file_source;
+        OscUdpReceiver receiver;
+        int port = 9200;
+        int audio_bits = 24;
+        std::string audio_file;
+
+        // --ndjson: escritura directa línea por línea (depuración a baja tasa)
+        // --audio-file=<wav>: fuente de audio simulada desde un WAV; --audio-bits=16|24|32
+        for (int i = 3; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--port=", 0) == 0) {
+                port = std::atoi(arg.c_str() + 7);
+            } else if (arg == "--ndjson") {
+                recorder.setRecordingMode(CalibRecorder::RecordingMode::Ndjson);
+            } else if (arg.rfind("--audio-file=", 0) == 0) {
+                audio_file = arg.substr(13);
+            } else if (arg.rfind("--audio-bits=", 0) == 0) {
+                audio_bits = std::atoi(arg.c_str() + 13);
+            }
+        }
+        if (!audio_file.empty()) {
+            if (!file_source.load(audio_file)) {
+                std::cerr << "Error: " << audio_file << " no es un WAV compatible" << std::endl;
+                return 1;
+            }
+            recorder.setAudioSource(&file_source, audio_bits);
+        }
+
+        // Fan-out de ISTR y /latency de PAS (ver OSC_SCHEMA.md); los mensajes previos a la sesión se ignoran
+        if (!receiver.start(port, &CalibRecorder::oscCallback, &recorder)) {
+            std::cerr << "Error: No se pudo escuchar OSC en el puerto " << port << std::endl;
+            return 1;
+        }
+        std::cout << "Escuchando OSC en el puerto " << port << std::endl;
+
+        if (!recorder.startSession(run_id)) {
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        bool ok = recorder.stopSession();
+        receiver.stop();
+        if (receiver.malformedCount() > 0) {
+            std::cout << "Paquetes OSC descartados (mal formados o tags no soportados): " << receiver.malformedCount() << std::endl;
+        }
+        return ok ? 0 : 1;
+    }
+
     // TODO: Inicializar cliente OSC para enviar comandos /test/*
-    
-    // TODO: Loop principal
-    // - Escuchar eventos OSC de oF y JUCE
-    // - Procesar comandos /test/* para control
-    // - Registrar eventos en NDJSON
-    // - Capturar audio
-    
-    std::cout << "Placeholder: Implementación pendiente" << std::endl;
+
+    std::cout << "Uso:" << std::endl;
+    std::cout << "  maad-2-calib record <segundos> [run_id] [--port=9200] [--ndjson] [--audio-file=<wav>] [--audio-bits=16|24|32]" << std::endl;
+    std::cout << "  maad-2-calib convert runs/<sesión>/run.bin [run.ndjson]" << std::endl;
+    std::cout << "  maad-2-calib latency runs/<sesión>/run.bin [--step=100] [--csv=latency.csv]" << std::endl;
     std::cout << "Ver specs/CALIB_SPEC.md para especificación completa" << std::endl;
     
     return 0;